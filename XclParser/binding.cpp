@@ -0,0 +1,65 @@
+﻿#include "pch.h"
+#include "binding.h"
+
+using namespace std;
+
+void xcl::binding_parser::expect(parser::token_stream& tokens, const parser::token_type type)
+{
+	if (type != parser::new_line)
+	{
+		skip_new_lines(tokens);
+	}
+	expect_token(tokens);
+	if (tokens.current().get_type() != type)
+	{
+		throw errors::unexpected_token_error(tokens.current());
+	}
+}
+
+void xcl::binding_parser::expect_token(parser::token_stream& tokens)
+{
+	if (tokens.at_end())
+	{
+		throw errors::unexpected_end_of_tokens_error(tokens.current());
+	}
+}
+
+void xcl::binding_parser::expect_end(parser::token_stream& tokens)
+{
+	skip_new_lines(tokens);
+	if (!tokens.at_end())
+	{
+		throw errors::unexpected_token_error(tokens.current());
+	}
+}
+
+void xcl::binding_parser::check_value(const types::type& type, const parser::token& token)
+{
+	// activating a string copies it, the scratch arena releases the copy right away
+	pmr::monotonic_buffer_resource scratch;
+	(void)type.activate(token, scratch);
+}
+
+void xcl::binding_parser::locate_error(errors::token_error& error, const parser::token_stream& tokens)
+{
+	if (!error.is_located())
+	{
+		if (const auto location = tokens.locate(error.get_position()))
+		{
+			error.set_location(*location);
+		}
+	}
+}
+
+std::string xcl::binding_parser::format_mismatch(const std::string_view context, const types::type& type, const std::string_view target)
+{
+	return std::format("{} has the type `{}` and can not be bound to {}.", context, type.get_name(), target);
+}
+
+void xcl::binding_parser::skip_new_lines(parser::token_stream& tokens)
+{
+	while (!tokens.at_end() && tokens.current().get_type() == parser::new_line)
+	{
+		tokens.advance();
+	}
+}
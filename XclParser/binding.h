@@ -0,0 +1,542 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <format>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "boolean.h"
+#include "document.h"
+#include "enumeration.h"
+#include "exception.h"
+#include "list.h"
+#include "number.h"
+#include "section.h"
+#include "symbol_table.h"
+#include "token_stream.h"
+#include "xcl_string.h"
+
+namespace xcl
+{
+	// describes a C++ struct or enum that is bound to an XCL section or enumeration, specialized for every bound type
+	//
+	//	template <>
+	//	struct xcl::schema<config>
+	//	{
+	//		static constexpr std::string_view type_name = "Config";
+	//		static constexpr auto fields = std::make_tuple(xcl::bind_field("Count", &config::count), xcl::bind_field("Mode", &config::mode));
+	//	};
+	//
+	//	template <>
+	//	struct xcl::schema<mode>
+	//	{
+	//		static constexpr std::string_view type_name = "Mode";
+	//		static constexpr auto values = std::to_array<xcl::enumerator_schema<mode>>({ { "Fast", mode::fast }, { "Safe", mode::safe } });
+	//	};
+	template <class T>
+	struct schema;
+
+	template <class Struct, class Member>
+	struct field_schema
+	{
+		typedef Member member_type;
+
+		std::string_view name;
+		Member Struct::* member;
+	};
+
+	template <class Struct, class Member>
+	[[nodiscard]] constexpr field_schema<Struct, Member> bind_field(const std::string_view name, Member Struct::* member) noexcept
+	{
+		return { name, member };
+	}
+
+	template <class Enum>
+	struct enumerator_schema
+	{
+		std::string_view name;
+		Enum value;
+	};
+
+	template <class T>
+	concept bound_section = std::is_class_v<T> && requires { schema<T>::type_name; schema<T>::fields; };
+
+	template <class T>
+	concept bound_enumeration = std::is_enum_v<T> && requires { schema<T>::type_name; schema<T>::values; };
+
+	// what a section field or a list member can be bound to, bool is bound to the boolean type and the other integers to int
+	template <class T>
+	concept bound_scalar = std::integral<T> || std::same_as<T, std::string> || bound_enumeration<T>;
+
+	// reads tokens with the grammar of the document parser, shared by all bindings
+	class binding_parser
+	{
+	public:
+		// skips new lines unless one is expected, throws at the end of the tokens or for a token of another type
+		static void expect(parser::token_stream& tokens, parser::token_type type);
+		static void expect_token(parser::token_stream& tokens);
+
+		// only new lines may follow the value
+		static void expect_end(parser::token_stream& tokens);
+
+		// syntax: { <Member>, <Member>, ... }
+		// read_member is called on the first token of every member and leaves the stream after it
+		template <class ReadMember>
+		static void parse_members(parser::token_stream& tokens, ReadMember&& read_member)
+		{
+			expect(tokens, parser::left_brace);
+			tokens.advance();
+
+			skip_new_lines(tokens);
+			while (tokens.at_end() || tokens.current().get_type() != parser::right_brace)
+			{
+				expect_token(tokens);
+				read_member(tokens);
+
+				skip_new_lines(tokens);
+				expect_token(tokens);
+				if (tokens.current().get_type() == parser::comma)
+				{
+					tokens.advance();
+					skip_new_lines(tokens);
+				}
+				else if (tokens.current().get_type() != parser::right_brace)
+				{
+					throw errors::unexpected_token_error(tokens.current());
+				}
+			}
+			tokens.advance();
+		}
+
+		// checks the value of a field that has no member bound to it
+		static void check_value(const types::type& type, const parser::token& token);
+
+		// line and column are only known while the stream is alive
+		static void locate_error(errors::token_error& error, const parser::token_stream& tokens);
+
+		[[nodiscard]] static std::string format_mismatch(std::string_view context, const types::type& type, std::string_view target);
+
+	private:
+		static void skip_new_lines(parser::token_stream& tokens);
+	};
+
+	template <bound_scalar T>
+	class scalar_binding
+	{
+	public:
+		// the context names what is bound in the messages of the mismatches
+		void bind(const types::type& type, const std::string_view context, std::vector<std::string>& mismatches)
+		{
+			if constexpr (std::same_as<T, bool>)
+			{
+				if (dynamic_cast<const types::boolean*>(&type) == nullptr)
+					mismatches.push_back(binding_parser::format_mismatch(context, type, "bool"));
+			}
+			else if constexpr (std::integral<T>)
+			{
+				if (dynamic_cast<const types::number*>(&type) == nullptr)
+					mismatches.push_back(binding_parser::format_mismatch(context, type, "an integer"));
+			}
+			else if constexpr (std::same_as<T, std::string>)
+			{
+				if (dynamic_cast<const types::string*>(&type) == nullptr)
+					mismatches.push_back(binding_parser::format_mismatch(context, type, "std::string"));
+			}
+			else
+			{
+				bind_enumeration(type, context, mismatches);
+			}
+		}
+
+		[[nodiscard]] T read(const xcl::value& value) const
+		{
+			if constexpr (std::same_as<T, bool>)
+				return value.as_boolean();
+			else if constexpr (std::integral<T>)
+				return narrow(value.as_integer());
+			else if constexpr (std::same_as<T, std::string>)
+				return std::string(value.as_string());
+			else
+				return values_[value.as_enumeration_index()];
+		}
+
+		[[nodiscard]] T parse(const parser::token& token) const
+		{
+			if constexpr (std::same_as<T, bool>)
+				return types::boolean::get_instance()->activate(token, *std::pmr::null_memory_resource()).as_boolean();
+			else if constexpr (std::integral<T>)
+				return narrow(types::number::get_instance()->activate(token, *std::pmr::null_memory_resource()).as_integer());
+			else if constexpr (std::same_as<T, std::string>)
+				return token.parse_string_literal();
+			else
+				return values_[enumeration_->activate(token, *std::pmr::null_memory_resource()).as_enumeration_index()];
+		}
+
+	private:
+		[[nodiscard]] static T narrow(const long integer)
+		{
+			if constexpr (!std::same_as<T, long>)
+			{
+				if (!std::in_range<T>(integer))
+				{
+					throw errors::xcl_runtime_error(std::format("The integer {} does not fit into its bound member.", integer));
+				}
+			}
+			return static_cast<T>(integer);
+		}
+
+		void bind_enumeration(const types::type& type, const std::string_view context, std::vector<std::string>& mismatches)
+		{
+			enumeration_ = dynamic_cast<const types::enumeration*>(&type);
+			if (enumeration_ == nullptr || enumeration_->get_name() != schema<T>::type_name)
+			{
+				mismatches.push_back(binding_parser::format_mismatch(context, type, std::format("the enumeration `{}`", schema<T>::type_name)));
+				return;
+			}
+
+			// the enumerators are stored by the index of their XCL value, so reading one is a single load
+			const auto& names = enumeration_->get_values();
+			values_.assign(names.size(), T{});
+			std::vector<bool> is_bound(names.size());
+			for (const auto& [name, value] : schema<T>::values)
+			{
+				const auto index = std::ranges::find(names, name) - names.begin();
+				if (index == static_cast<ptrdiff_t>(names.size()))
+				{
+					mismatches.push_back(std::format("The value `{}` is not defined in the enumeration `{}`.", name, enumeration_->get_name()));
+					continue;
+				}
+				values_[index] = value;
+				is_bound[index] = true;
+			}
+			for (size_t index = 0; index < names.size(); ++index)
+			{
+				if (!is_bound[index])
+					mismatches.push_back(std::format("The value `{}` of the enumeration `{}` is not bound.", names[index], enumeration_->get_name()));
+			}
+		}
+
+		const types::enumeration* enumeration_{nullptr};
+		std::vector<T> values_;
+	};
+
+	template <bound_section T>
+	class section_binding
+	{
+	public:
+		void bind(const types::type& type, const std::string_view context, std::vector<std::string>& mismatches)
+		{
+			section_ = dynamic_cast<const types::section*>(&type);
+			if (section_ == nullptr || section_->get_name() != schema<T>::type_name)
+			{
+				mismatches.push_back(binding_parser::format_mismatch(context, type, std::format("the section `{}`", schema<T>::type_name)));
+				return;
+			}
+
+			const auto first_mismatch = mismatches.size();
+			members_.assign(section_->get_fields().size(), unbound);
+			for (size_t slot = 0; slot < section_->get_fields().size(); ++slot)
+			{
+				if (!section_->get_fields()[slot]->has_default_value())
+					required_slots_.push_back(slot);
+			}
+			bind_fields(mismatches, std::make_index_sequence<field_count>());
+
+			// the defaults are read once, every parse starts from a copy of them
+			if (mismatches.size() == first_mismatch)
+				read_defaults(std::make_index_sequence<field_count>());
+		}
+
+		[[nodiscard]] T read(const xcl::value& value) const
+		{
+			const auto& section = value.as_section();
+			if (&section.get_type() != section_)
+			{
+				throw errors::type_mismatch_error(section.get_type(), *section_);
+			}
+
+			T result = defaults_;
+			read_fields(section, result, std::make_index_sequence<field_count>());
+			return result;
+		}
+
+		void parse(parser::token_stream& tokens, T& result) const
+		{
+			// syntax: { <Identifier> = <Value>, <Identifier> = <Value>, ... }
+
+			result = defaults_;
+			std::vector<bool> is_set(members_.size());
+			binding_parser::parse_members(tokens, [&](parser::token_stream& tokens)
+			{
+				binding_parser::expect(tokens, parser::identifier);
+				const auto slot = section_->resolve_slot(tokens.current().get_text());
+				tokens.advance();
+
+				binding_parser::expect(tokens, parser::equals);
+				tokens.advance();
+
+				binding_parser::expect_token(tokens);
+				if (const auto member = members_[slot]; member != unbound)
+					parsers_[member](*this, tokens.current(), result);
+				else
+					binding_parser::check_value(section_->get_fields()[slot]->get_type(), tokens.current());
+				tokens.advance();
+
+				is_set[slot] = true;
+			});
+
+			for (const auto slot : required_slots_)
+			{
+				if (!is_set[slot])
+					throw errors::required_field_not_set_error(section_->get_fields()[slot]->get_name(), section_->get_name());
+			}
+		}
+
+	private:
+		typedef std::remove_cvref_t<decltype(schema<T>::fields)> fields_tuple;
+
+		static constexpr size_t field_count = std::tuple_size_v<fields_tuple>;
+		static constexpr size_t unbound = static_cast<size_t>(-1);
+
+		template <class Fields>
+		struct member_bindings;
+
+		template <class... Fields>
+		struct member_bindings<std::tuple<Fields...>>
+		{
+			typedef std::tuple<scalar_binding<typename Fields::member_type>...> type;
+		};
+
+		typedef void (*parse_member_fn)(const section_binding&, const parser::token&, T&);
+
+		template <size_t... Index>
+		void bind_fields(std::vector<std::string>& mismatches, std::index_sequence<Index...>)
+		{
+			(bind_field<Index>(mismatches), ...);
+		}
+
+		template <size_t Index>
+		void bind_field(std::vector<std::string>& mismatches)
+		{
+			const auto& field = std::get<Index>(schema<T>::fields);
+			const auto slot = section_->find_slot(field.name);
+			if (!slot)
+			{
+				mismatches.push_back(std::format("The field `{}` is not defined in the section `{}`.", field.name, section_->get_name()));
+				return;
+			}
+
+			slots_[Index] = *slot;
+			members_[*slot] = Index;
+			parsers_[Index] = &parse_member<Index>;
+			std::get<Index>(bindings_).bind(section_->get_fields()[*slot]->get_type(), std::format("The field `{}` of `{}`", field.name, section_->get_name()), mismatches);
+		}
+
+		template <size_t... Index>
+		void read_defaults(std::index_sequence<Index...>)
+		{
+			(read_default<Index>(), ...);
+		}
+
+		template <size_t Index>
+		void read_default()
+		{
+			if (const auto& value = section_->get_default_value(slots_[Index]); !value.is_empty())
+				defaults_.*std::get<Index>(schema<T>::fields).member = std::get<Index>(bindings_).read(value);
+		}
+
+		template <size_t... Index>
+		void read_fields(const objects::section& section, T& result, std::index_sequence<Index...>) const
+		{
+			(read_field<Index>(section, result), ...);
+		}
+
+		template <size_t Index>
+		void read_field(const objects::section& section, T& result) const
+		{
+			if (const auto& value = section.find_value(slots_[Index]); !value.is_empty())
+				result.*std::get<Index>(schema<T>::fields).member = std::get<Index>(bindings_).read(value);
+		}
+
+		template <size_t Index>
+		static void parse_member(const section_binding& binding, const parser::token& token, T& result)
+		{
+			result.*std::get<Index>(schema<T>::fields).member = std::get<Index>(binding.bindings_).parse(token);
+		}
+
+		const types::section* section_{nullptr};
+		typename member_bindings<fields_tuple>::type bindings_;
+		// slot of every bound member, and the bound member of every slot
+		std::array<size_t, field_count> slots_{};
+		std::array<parse_member_fn, field_count> parsers_{};
+		std::vector<size_t> members_;
+		std::vector<size_t> required_slots_;
+		T defaults_{};
+	};
+
+	template <bound_scalar T>
+	class list_binding
+	{
+	public:
+		void bind(const types::type& type, const std::string_view context, std::vector<std::string>& mismatches)
+		{
+			list_ = dynamic_cast<const types::list*>(&type);
+			if (list_ == nullptr)
+			{
+				mismatches.push_back(binding_parser::format_mismatch(context, type, "a list"));
+				return;
+			}
+			member_.bind(list_->get_contained_type(), std::format("A member of `{}`", list_->get_name()), mismatches);
+		}
+
+		[[nodiscard]] std::vector<T> read(const xcl::value& value) const
+		{
+			const auto& list = value.as_list();
+			if (&list.get_type() != list_)
+			{
+				throw errors::type_mismatch_error(list.get_type(), *list_);
+			}
+
+			std::vector<T> result;
+			result.reserve(list.get_values().size());
+			for (const auto& member : list.get_values())
+			{
+				result.push_back(member_.read(member));
+			}
+			return result;
+		}
+
+		void parse(parser::token_stream& tokens, std::vector<T>& result) const
+		{
+			// syntax: { <Value>, <Value>, ... }
+
+			result.clear();
+			binding_parser::parse_members(tokens, [&](parser::token_stream& tokens)
+			{
+				result.push_back(member_.parse(tokens.current()));
+				tokens.advance();
+			});
+		}
+
+	private:
+		const types::list* list_{nullptr};
+		scalar_binding<T> member_;
+	};
+
+	template <class T>
+	struct binding_implementation;
+
+	template <bound_scalar T>
+	struct binding_implementation<T>
+	{
+		typedef scalar_binding<T> type;
+	};
+
+	template <bound_section T>
+	struct binding_implementation<T>
+	{
+		typedef section_binding<T> type;
+	};
+
+	template <bound_scalar T>
+	struct binding_implementation<std::vector<T>>
+	{
+		typedef list_binding<T> type;
+	};
+
+	// maps values of an XCL type onto a C++ type, the type is checked once when it is bound and every mismatch is reported together
+	// values are read by slot, and parsed from tokens straight into the C++ type without building any objects
+	// a binding refers to the type it was bound to, it can only read values of the document defining that type
+	template <class T>
+	class binding
+	{
+	public:
+		explicit binding(const types::type& type)
+		{
+			std::vector<std::string> mismatches;
+			implementation_.bind(type, "The bound value", mismatches);
+			if (!mismatches.empty())
+			{
+				throw errors::schema_mismatch_error(type.get_name(), std::move(mismatches));
+			}
+		}
+
+		// binds the type named by the schema, as it is resolved by the document
+		[[nodiscard]] static binding bind(const xcl::document& document) requires bound_section<T> || bound_enumeration<T>
+		{
+			return binding(document.resolve_type(symbol_table::get_instance().intern(schema<T>::type_name)));
+		}
+
+		[[nodiscard]] T read(const xcl::value& value) const
+		{
+			return implementation_.read(value);
+		}
+
+		[[nodiscard]] T read(const xcl::document& document, const std::string_view name) const
+		{
+			const auto value = document.find_data(name);
+			if (value == nullptr)
+			{
+				throw errors::xcl_runtime_error(std::format("The value `{}` is not defined.", name));
+			}
+			return read(*value);
+		}
+
+		// parses the value as it follows the name of a data definition, a section or list in braces and a scalar after `=`
+		[[nodiscard]] T parse(parser::token_stream& tokens) const
+		{
+			try
+			{
+				if constexpr (bound_scalar<T>)
+				{
+					binding_parser::expect(tokens, parser::equals);
+					tokens.advance();
+
+					binding_parser::expect_token(tokens);
+					auto result = implementation_.parse(tokens.current());
+					tokens.advance();
+					return result;
+				}
+				else
+				{
+					T result;
+					implementation_.parse(tokens, result);
+					return result;
+				}
+			}
+			catch (errors::token_error& error)
+			{
+				binding_parser::locate_error(error, tokens);
+				throw;
+			}
+		}
+
+		// the text holds nothing but the value
+		[[nodiscard]] T parse(const std::string_view text) const
+		{
+			parser::source_token_stream tokens(text);
+			auto result = parse(tokens);
+			try
+			{
+				binding_parser::expect_end(tokens);
+			}
+			catch (errors::token_error& error)
+			{
+				binding_parser::locate_error(error, tokens);
+				throw;
+			}
+			return result;
+		}
+
+	private:
+		typename binding_implementation<T>::type implementation_;
+	};
+}
@@ -6,12 +6,12 @@
 
 std::shared_ptr<xcl::types::boolean> xcl::types::boolean::instance_ = std::make_shared<xcl::types::boolean>();
 
-std::unique_ptr<xcl::objects::boolean> xcl::types::boolean::activate(const bool value) const noexcept
+xcl::value xcl::types::boolean::activate(const bool value) const noexcept
 {
-	return std::make_unique<xcl::objects::boolean>(*this, value);
+	return { *this, value };
 }
 
-std::unique_ptr<xcl::objects::object> xcl::types::boolean::activate(const xcl::parser::token& token) const
+xcl::value xcl::types::boolean::activate(const xcl::parser::token& token, std::pmr::memory_resource&) const
 {
 	if (token.get_type() != parser::identifier)
 		throw errors::unexpected_token_error(token);
@@ -22,9 +22,9 @@ std::unique_ptr<xcl::objects::object> xcl::types::boolean::activate(const xcl::p
 	throw errors::unexpected_token_error(token);
 }
 
-std::unique_ptr<xcl::objects::object> xcl::objects::boolean::clone() const
+xcl::objects::object* xcl::objects::boolean::clone(std::pmr::memory_resource& arena) const
 {
-	return std::make_unique<xcl::objects::boolean>(*this);
+	return allocate_object<xcl::objects::boolean>(arena, *this);
 }
 
 std::string xcl::objects::boolean::to_string() const
@@ -15,8 +15,8 @@ namespace xcl::types
 	public:
 		boolean() : type("bool") {}
 
-		[[nodiscard]] std::unique_ptr<xcl::objects::boolean> activate(bool value) const noexcept;
-		[[nodiscard]] std::unique_ptr<xcl::objects::object> activate(const xcl::parser::token&) const override;
+		[[nodiscard]] xcl::value activate(bool value) const noexcept;
+		[[nodiscard]] xcl::value activate(const xcl::parser::token&, std::pmr::memory_resource& arena) const override;
 
 		bool is_custom_type() override { return false; }
 
@@ -34,11 +34,14 @@ namespace xcl::objects
 	public:
 		boolean(const xcl::types::boolean& type, const bool value) : object(type), value_(value) {}
 
-		[[nodiscard]] std::unique_ptr<xcl::objects::object> clone() const override;
+		[[nodiscard]] xcl::objects::object* clone(std::pmr::memory_resource& arena) const override;
 
 		[[nodiscard]] bool get_value() const { return value_; }
 		[[nodiscard]] std::string to_string() const override;
 
+	protected:
+		[[nodiscard]] size_t compute_hash() const noexcept override { return xcl::value(static_cast<const xcl::types::boolean&>(get_type()), value_).get_hash(); }
+
 	private:
 		bool value_;
 	};
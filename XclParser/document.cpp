@@ -1,95 +1,162 @@
 ﻿#include "pch.h"
 #include "document.h"
 
-#include <ranges>
-
 #include "boolean.h"
 #include "number.h"
 #include "xcl_string.h"
 
 using namespace std;
 
-xcl::document::document(const bool is_imported) : is_imported_(is_imported)
+namespace
+{
+	// the builtin types are registered once for all documents
+	const unordered_map<xcl::symbol, shared_ptr<xcl::types::type>>& builtin_types()
+	{
+		static const auto types = []
+		{
+			using xcl::types::type;
+			auto& symbols = xcl::symbol_table::get_instance();
+			unordered_map<xcl::symbol, shared_ptr<type>> result;
+			for (const auto& builtin : initializer_list<shared_ptr<type>>{ xcl::types::boolean::get_instance(), xcl::types::number::get_instance(), xcl::types::string::get_instance() })
+			{
+				result.emplace(symbols.intern(builtin->get_name()), builtin);
+			}
+			return result;
+		}();
+		return types;
+	}
+}
+
+xcl::document::document(const bool is_imported) :
+	arena_(std::make_unique<std::pmr::monotonic_buffer_resource>()),
+	data_(*arena_),
+	is_imported_(is_imported)
 {
-	using namespace xcl::types;
-	register_type(boolean::get_instance());
-	register_type(number::get_instance());
-	register_type(string::get_instance());
 }
 
-void xcl::document::add_data(const std::string& name, std::unique_ptr<xcl::objects::object> value)
+void xcl::document::add_data(const std::string_view name, const xcl::value& value)
 {
 	if (is_imported_)
 	{
 		throw errors::xcl_runtime_error("Values can not be added to an imported document.");
 	}
 
-	data_[name] = std::move(value);
+	data_.insert_or_assign(name, value);
 }
 
-void xcl::document::register_type(std::shared_ptr<xcl::types::type> type) noexcept
+void xcl::document::adopt_data(document&& other)
 {
-	if (types_.contains(type->get_name()))
+	for (const auto& [name, value] : other.data_)
 	{
-		throw errors::xcl_runtime_error(std::format("A data type with name `{}` is already registered.", type->get_name()));
+		add_data(name, value);
 	}
-	types_[type->get_name()] = std::move(type);
+	adopted_arenas_.push_back(std::move(other.arena_));
+	adopted_arenas_.insert(adopted_arenas_.end(), std::make_move_iterator(other.adopted_arenas_.begin()), std::make_move_iterator(other.adopted_arenas_.end()));
 }
 
-void xcl::document::import_document(const document& target)
+void xcl::document::splice_data(const size_t first, const size_t count, document&& other)
 {
-	for (const auto& type : target.types_ | views::values)
+	if (is_imported_)
 	{
-		if (type->is_custom_type())
-		{
-			register_type(type);
-		}
+		throw errors::xcl_runtime_error("Values can not be added to an imported document.");
 	}
 
-	for (const auto& [name, value] : target.data_)
+	data_.splice(first, count, other.data_);
+	adopted_arenas_.push_back(std::move(other.arena_));
+	adopted_arenas_.insert(adopted_arenas_.end(), std::make_move_iterator(other.adopted_arenas_.begin()), std::make_move_iterator(other.adopted_arenas_.end()));
+}
+
+void xcl::document::register_type(std::shared_ptr<xcl::types::type> type)
+{
+	const auto name = symbol_table::get_instance().intern(type->get_name());
+	if (builtin_types().contains(name) || find_custom_type(name) != nullptr)
 	{
-		add_data(name, value->clone());
+		throw errors::xcl_runtime_error(std::format("A data type with name `{}` is already registered.", type->get_name()));
 	}
+	types_.emplace(name, std::move(type));
+}
+
+void xcl::document::import_document(std::shared_ptr<const document> target)
+{
+	imports_.push_back(std::move(target));
+}
+
+const xcl::types::type& xcl::document::resolve_type(const xcl::symbol name) const
+{
+	return *find_type(name);
+}
 
-	for (const auto& [name, type] : target.requireds_)
+void xcl::document::add_required_definition(const xcl::symbol name, const std::shared_ptr<xcl::types::type>& type)
+{
+	if (resolve_required_definition(name) != nullptr)
 	{
-		add_required_definition(name, type);
+		throw errors::xcl_runtime_error(std::format("The required name `{}` is already defined.", symbol_table::get_instance().get_name(name)));
 	}
+	requireds_.emplace(name, type);
 }
 
-const xcl::types::type& xcl::document::resolve_type(const std::string& name) const
+std::shared_ptr<xcl::types::type> xcl::document::resolve_required_definition(const xcl::symbol name) const noexcept
 {
-	if (types_.contains(name))
+	if (const auto required = requireds_.find(name); required != requireds_.end())
+	{
+		return required->second;
+	}
+	for (const auto& import : imports_)
 	{
-		return *types_.at(name);
+		if (auto required = import->resolve_required_definition(name))
+		{
+			return required;
+		}
 	}
-	throw errors::type_not_found_error(name);
+	return nullptr;
 }
 
-void xcl::document::add_required_definition(const std::string& name, const std::shared_ptr<xcl::types::type>& type)
+const xcl::value* xcl::document::find_data(const std::string_view name) const noexcept
 {
-	if (requireds_.contains(name))
+	if (const auto value = data_.find(name); value != data_.end())
 	{
-		throw errors::xcl_runtime_error(std::format("The required name `{}` is already defined.", name));
+		return &value->second;
 	}
+	for (const auto& import : imports_)
+	{
+		if (const auto value = import->find_data(name))
+		{
+			return value;
+		}
+	}
+	return nullptr;
+}
 
-	requireds_[name] = type;
+std::shared_ptr<xcl::types::type> xcl::document::resolve_type_ptr(const xcl::symbol name) const
+{
+	return find_type(name);
 }
 
-std::shared_ptr<xcl::types::type> xcl::document::resolve_required_definition(const std::string& name) noexcept
+const std::shared_ptr<xcl::types::type>& xcl::document::find_type(const xcl::symbol name) const
 {
-	if (requireds_.contains(name))
+	if (const auto type = builtin_types().find(name); type != builtin_types().end())
 	{
-		return requireds_[name];
+		return type->second;
 	}
-	return nullptr;
+	if (const auto type = find_custom_type(name))
+	{
+		return *type;
+	}
+	throw errors::type_not_found_error(std::string(symbol_table::get_instance().get_name(name)));
 }
 
-std::shared_ptr<xcl::types::type> xcl::document::resolve_type_ptr(const std::string& name)
+const std::shared_ptr<xcl::types::type>* xcl::document::find_custom_type(const xcl::symbol name) const noexcept
 {
-	if (types_.contains(name))
+	if (const auto type = types_.find(name); type != types_.end())
 	{
-		return types_[name];
+		return &type->second;
 	}
-	throw errors::type_not_found_error(name);
-}
\ No newline at end of file
+	for (const auto& import : imports_)
+	{
+		if (const auto type = import->find_custom_type(name))
+		{
+			return type;
+		}
+	}
+	return nullptr;
+}
@@ -1,12 +1,17 @@
 ﻿#pragma once
 
 #include <memory>
-#include <map>
+#include <memory_resource>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
 #include "exception.h"
+#include "flat_map.h"
+#include "symbol_table.h"
 #include "type.h"
 #include "object.h"
+#include "value.h"
 
 namespace xcl
 {
@@ -15,30 +20,66 @@ namespace xcl
 	public:
 		explicit document(bool is_imported);
 
-		void add_data(const std::string& name, std::unique_ptr<xcl::objects::object> value);
+		document(document&& other) noexcept = default;
+		document& operator=(document&& other) = delete;
 
-		void register_type(std::shared_ptr<xcl::types::type> type) noexcept;
+		// every object, string and container of the document is allocated here and released with it at once
+		[[nodiscard]] std::pmr::memory_resource& get_arena() const noexcept { return *arena_; }
 
-		void import_document(const document& target);
+		void add_data(std::string_view name, const xcl::value& value);
 
-		void add_required_definition(const std::string& name, const std::shared_ptr<xcl::types::type>& type);
+		// appends the values of the other document in their order, its arena is kept alive with this document
+		void adopt_data(document&& other);
 
-		[[nodiscard]] std::shared_ptr<xcl::types::type> resolve_required_definition(const std::string& name) noexcept;
+		// replaces count values from first with the values of the other document in their place, its arena is kept alive with this document
+		void splice_data(size_t first, size_t count, document&& other);
 
-		[[nodiscard]] const std::map<std::string, std::unique_ptr<xcl::objects::object>>& get_data() const noexcept { return data_; }
+		void register_type(std::shared_ptr<xcl::types::type> type);
 
-		[[nodiscard]] const std::map<std::string, std::shared_ptr<xcl::types::type>>& get_types() const noexcept { return types_; }
+		// the imported document becomes a read-only parent scope, nothing of it is copied
+		void import_document(std::shared_ptr<const document> target);
 
-		[[nodiscard]] const std::map<std::string, std::shared_ptr<xcl::types::type>>& get_required_definitions() const noexcept { return requireds_; }
+		void add_required_definition(xcl::symbol name, const std::shared_ptr<xcl::types::type>& type);
 
-		[[nodiscard]] const xcl::types::type& resolve_type(const std::string& name) const;
+		// resolution walks this document first and then its imports
+		[[nodiscard]] std::shared_ptr<xcl::types::type> resolve_required_definition(xcl::symbol name) const noexcept;
 
-		[[nodiscard]] std::shared_ptr<xcl::types::type> resolve_type_ptr(const std::string& name);
+		[[nodiscard]] const xcl::value* find_data(std::string_view name) const noexcept;
+
+		// top level values of this document only, in the order they are defined
+		[[nodiscard]] const xcl::ordered_flat_map<xcl::value>& get_data() const noexcept { return data_; }
+
+		// custom types of this document only, the builtin types are shared by all documents
+		[[nodiscard]] const std::unordered_map<xcl::symbol, std::shared_ptr<xcl::types::type>>& get_types() const noexcept { return types_; }
+
+		[[nodiscard]] const std::unordered_map<xcl::symbol, std::shared_ptr<xcl::types::type>>& get_required_definitions() const noexcept { return requireds_; }
+
+		[[nodiscard]] const std::vector<std::shared_ptr<const document>>& get_imports() const noexcept { return imports_; }
+
+		// visits the required definitions of this document and of all of its imports
+		template <class Visitor>
+		void for_each_required_definition(Visitor&& visitor) const
+		{
+			for (const auto& [name, type] : requireds_)
+				visitor(name, *type);
+			for (const auto& import : imports_)
+				import->for_each_required_definition(visitor);
+		}
+
+		[[nodiscard]] const xcl::types::type& resolve_type(xcl::symbol name) const;
+
+		[[nodiscard]] std::shared_ptr<xcl::types::type> resolve_type_ptr(xcl::symbol name) const;
 
 	private:
-		std::map<std::string, std::unique_ptr<xcl::objects::object>> data_;
-		std::map<std::string, std::shared_ptr<xcl::types::type>> types_;
-		std::map<std::string, std::shared_ptr<xcl::types::type>> requireds_;
+		[[nodiscard]] const std::shared_ptr<xcl::types::type>& find_type(xcl::symbol name) const;
+		[[nodiscard]] const std::shared_ptr<xcl::types::type>* find_custom_type(xcl::symbol name) const noexcept;
+
+		std::unique_ptr<std::pmr::monotonic_buffer_resource> arena_;
+		std::vector<std::unique_ptr<std::pmr::monotonic_buffer_resource>> adopted_arenas_;
+		std::vector<std::shared_ptr<const document>> imports_;
+		xcl::ordered_flat_map<xcl::value> data_;
+		std::unordered_map<xcl::symbol, std::shared_ptr<xcl::types::type>> types_;
+		std::unordered_map<xcl::symbol, std::shared_ptr<xcl::types::type>> requireds_;
 		bool is_imported_;
 	};
 
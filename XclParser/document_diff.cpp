@@ -0,0 +1,97 @@
+﻿#include "pch.h"
+#include "document_diff.h"
+
+#include <format>
+#include <ranges>
+
+#include "list.h"
+#include "section.h"
+
+using namespace std;
+
+namespace
+{
+	void diff_values(const string& path, const xcl::value& before, const xcl::value& after, vector<xcl::document_change>& changes);
+
+	void diff_sections(const string& path, const xcl::objects::section& before, const xcl::objects::section& after, vector<xcl::document_change>& changes)
+	{
+		// the types of the two documents are matched by the names of their fields, since a reload may add or remove fields
+		const auto& before_type = static_cast<const xcl::types::section&>(before.get_type());
+		const auto& after_type = static_cast<const xcl::types::section&>(after.get_type());
+		for (size_t slot = 0; slot < after_type.get_fields().size(); ++slot)
+		{
+			const auto& name = after_type.get_fields()[slot]->get_name();
+			const auto before_slot = before_type.find_slot(name);
+			const auto& before_value = before_slot ? before.find_value(*before_slot) : xcl::value();
+			// the path is only built for members that differ
+			if (before_value.get_hash() != after.find_value(slot).get_hash())
+				diff_values(format("{}.{}", path, name), before_value, after.find_value(slot), changes);
+		}
+		for (size_t slot = 0; slot < before_type.get_fields().size(); ++slot)
+		{
+			if (const auto& name = before_type.get_fields()[slot]->get_name(); !after_type.find_slot(name))
+				diff_values(format("{}.{}", path, name), before.find_value(slot), xcl::value(), changes);
+		}
+	}
+
+	void diff_lists(const string& path, const xcl::objects::list& before, const xcl::objects::list& after, vector<xcl::document_change>& changes)
+	{
+		const auto& before_values = before.get_values();
+		const auto& after_values = after.get_values();
+		for (size_t index = 0; index < max(before_values.size(), after_values.size()); ++index)
+		{
+			const auto& before_value = index < before_values.size() ? before_values[index] : xcl::value();
+			const auto& after_value = index < after_values.size() ? after_values[index] : xcl::value();
+			if (before_value.get_hash() != after_value.get_hash())
+				diff_values(format("{}[{}]", path, index), before_value, after_value, changes);
+		}
+	}
+
+	void diff_values(const string& path, const xcl::value& before, const xcl::value& after, vector<xcl::document_change>& changes)
+	{
+		if (before.get_hash() == after.get_hash())
+			return;
+
+		if (before.is_empty())
+		{
+			changes.push_back({ xcl::added_path, path });
+		}
+		else if (after.is_empty())
+		{
+			changes.push_back({ xcl::removed_path, path });
+		}
+		else if (before.get_kind() != after.get_kind() || before.get_type().get_name() != after.get_type().get_name())
+		{
+			changes.push_back({ xcl::changed_path, path });
+		}
+		else if (after.get_kind() == xcl::section_value)
+		{
+			diff_sections(path, before.as_section(), after.as_section(), changes);
+		}
+		else if (after.get_kind() == xcl::list_value)
+		{
+			diff_lists(path, before.as_list(), after.as_list(), changes);
+		}
+		else
+		{
+			changes.push_back({ xcl::changed_path, path });
+		}
+	}
+}
+
+std::vector<xcl::document_change> xcl::diff_documents(const document& before, const document& after)
+{
+	vector<document_change> result;
+	for (const auto& [name, data] : after.get_data())
+	{
+		const auto previous = before.get_data().find(name);
+		if (const auto& before_value = previous != before.get_data().end() ? previous->second : xcl::value(); before_value.get_hash() != data.get_hash())
+			diff_values(string(name), before_value, data, result);
+	}
+	for (const auto& name : before.get_data() | views::keys)
+	{
+		if (!after.get_data().contains(name))
+			result.push_back({ removed_path, string(name) });
+	}
+	return result;
+}
@@ -0,0 +1,27 @@
+﻿#pragma once
+
+#include <string>
+#include <vector>
+
+#include "document.h"
+
+namespace xcl
+{
+	enum change_kind : unsigned char
+	{
+		added_path,
+		removed_path,
+		changed_path,
+	};
+
+	// paths name top level values, fields of sections after a dot and members of lists by their index, like `global.Text` or `exclude[2]`
+	struct document_change
+	{
+		change_kind kind;
+		std::string path;
+	};
+
+	// the values of the documents are compared by their structural hashes, a subtree with equal hashes is not walked
+	// a value whose type changed is reported as changed as a whole, added and changed paths come in the order of the second document
+	[[nodiscard]] std::vector<document_change> diff_documents(const document& before, const document& after);
+}
@@ -0,0 +1,234 @@
+﻿#include "pch.h"
+#include "document_reloader.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include <ranges>
+
+#include "exception.h"
+#include "import_graph.h"
+
+using namespace std;
+
+xcl::document_reloader::document_reloader(std::filesystem::path root, parser::document_parser parser) : root_(std::move(root)), parser_(std::move(parser))
+{
+	stamps_ = stamp_files();
+	publish(make_shared<const xcl::document>(parser_.parse_file(root_)));
+	watcher_ = thread(&document_reloader::watch, this);
+}
+
+xcl::document_reloader::~document_reloader()
+{
+	is_stopping_ = true;
+	watcher_.join();
+}
+
+bool xcl::document_reloader::reload()
+{
+	lock_guard lock(reload_mutex_);
+	const auto start = chrono::steady_clock::now();
+
+	// the files are stamped before they are parsed, so a change during the parse triggers another reload
+	auto stamps = stamp_files();
+	auto is_published = false;
+	try
+	{
+		publish(make_shared<const xcl::document>(parser_.parse_file(root_)));
+		is_published = true;
+		++reload_count_;
+	}
+	catch (const errors::xcl_exception& error)
+	{
+		lock_guard error_lock(error_mutex_);
+		last_error_ = error.get_message();
+		++failure_count_;
+	}
+	catch (const filesystem::filesystem_error& error)
+	{
+		lock_guard error_lock(error_mutex_);
+		last_error_ = error.what();
+		++failure_count_;
+	}
+	catch (const exception& error)
+	{
+		// running out of memory or threads fails the reload as well, the watcher thread must not end the process
+		lock_guard error_lock(error_mutex_);
+		last_error_ = error.what();
+		++failure_count_;
+	}
+
+	stamps_ = std::move(stamps);
+	last_latency_ = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+	return is_published;
+}
+
+std::string xcl::document_reloader::get_last_error() const
+{
+	lock_guard lock(error_mutex_);
+	return last_error_;
+}
+
+std::map<std::filesystem::path, xcl::document_reloader::file_stamp> xcl::document_reloader::stamp_files() const
+{
+	vector files{ root_ };
+	try
+	{
+		for (const parser::import_graph graph(root_); const auto& level : graph.get_levels())
+		{
+			files.insert(files.end(), level.begin(), level.end());
+		}
+	}
+	catch (const exception&)
+	{
+		// the parse fails on a broken import graph as well, the files watched so far stay watched until it is fixed
+		for (const auto& path : stamps_ | views::keys)
+		{
+			files.push_back(path);
+		}
+	}
+
+	map<filesystem::path, file_stamp> result;
+	for (const auto& file : files)
+	{
+		// a missing file has a stamp of its own, so it is noticed when it appears
+		error_code time_error, size_error;
+		result.try_emplace(file, filesystem::last_write_time(file, time_error), filesystem::file_size(file, size_error));
+	}
+	return result;
+}
+
+bool xcl::document_reloader::is_changed() const
+{
+	lock_guard lock(reload_mutex_);
+	return ranges::any_of(stamps_, [](const auto& entry)
+	{
+		error_code time_error, size_error;
+		return entry.second != file_stamp(filesystem::last_write_time(entry.first, time_error), filesystem::file_size(entry.first, size_error));
+	});
+}
+
+std::set<std::filesystem::path> xcl::document_reloader::get_watched_directories() const
+{
+	lock_guard lock(reload_mutex_);
+	set<filesystem::path> result;
+	for (const auto& path : stamps_ | views::keys)
+	{
+		result.insert(path.has_parent_path() ? path.parent_path() : filesystem::path("."));
+	}
+	return result;
+}
+
+void xcl::document_reloader::publish(std::shared_ptr<const xcl::document> document)
+{
+	snapshot_.store(std::move(document), memory_order_release);
+	generation_.fetch_add(1, memory_order_release);
+}
+
+#ifdef _WIN32
+
+void xcl::document_reloader::watch()
+{
+	// a change notification only tells that something in a directory changed, the stamps tell whether it was a watched file
+	set<filesystem::path> directories;
+	vector<HANDLE> notifications;
+	const auto update_notifications = [&]
+	{
+		auto watched = get_watched_directories();
+		if (watched == directories)
+			return;
+		for (const auto notification : notifications)
+			FindCloseChangeNotification(notification);
+		notifications.clear();
+		for (const auto& directory : watched)
+		{
+			const auto notification = FindFirstChangeNotificationW(directory.c_str(), FALSE, FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_SIZE | FILE_NOTIFY_CHANGE_LAST_WRITE);
+			if (notification != INVALID_HANDLE_VALUE)
+				notifications.push_back(notification);
+		}
+		directories = std::move(watched);
+	};
+
+	update_notifications();
+	while (!is_stopping_)
+	{
+		if (notifications.empty())
+		{
+			this_thread::sleep_for(watch_interval);
+			continue;
+		}
+
+		const auto count = static_cast<DWORD>((std::min<size_t>)(notifications.size(), MAXIMUM_WAIT_OBJECTS));
+		const auto signaled = WaitForMultipleObjects(count, notifications.data(), FALSE, static_cast<DWORD>(watch_interval.count()));
+		if (signaled >= WAIT_OBJECT_0 + count)
+			continue;
+
+		FindNextChangeNotification(notifications[signaled - WAIT_OBJECT_0]);
+		if (is_changed())
+		{
+			(void)reload();
+			update_notifications();
+		}
+	}
+
+	for (const auto notification : notifications)
+		FindCloseChangeNotification(notification);
+}
+
+#else
+
+void xcl::document_reloader::watch()
+{
+	const auto notifier = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (notifier == -1)
+	{
+		lock_guard error_lock(error_mutex_);
+		last_error_ = "The files can not be watched.";
+		return;
+	}
+
+	// the events only wake the watcher, the stamps tell whether a watched file changed
+	set<filesystem::path> directories;
+	vector<int> watches;
+	const auto update_watches = [&]
+	{
+		auto watched = get_watched_directories();
+		if (watched == directories)
+			return;
+		for (const auto watch : watches)
+			inotify_rm_watch(notifier, watch);
+		watches.clear();
+		for (const auto& directory : watched)
+		{
+			// editors often replace a file by moving a new one over it, so the directory is watched rather than the file
+			if (const auto watch = inotify_add_watch(notifier, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE); watch != -1)
+				watches.push_back(watch);
+		}
+		directories = std::move(watched);
+	};
+
+	update_watches();
+	alignas(inotify_event) char events[4096];
+	while (!is_stopping_)
+	{
+		pollfd descriptor{ notifier, POLLIN, 0 };
+		if (poll(&descriptor, 1, static_cast<int>(watch_interval.count())) <= 0)
+			continue;
+
+		while (read(notifier, events, sizeof events) > 0) {}
+		if (is_changed())
+		{
+			(void)reload();
+			update_watches();
+		}
+	}
+
+	close(notifier);
+}
+
+#endif
@@ -0,0 +1,106 @@
+﻿#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include "document.h"
+#include "parser.h"
+
+namespace xcl
+{
+	// watches a root file and the files it imports, and publishes a new immutable snapshot of the document whenever one of them changes
+	// a reload that fails keeps the current snapshot
+	class document_reloader
+	{
+	public:
+		// the root is parsed right away, a failure of this first parse is thrown
+		explicit document_reloader(std::filesystem::path root, parser::document_parser parser = {});
+		document_reloader(const document_reloader&) = delete;
+		document_reloader(document_reloader&&) = delete;
+		~document_reloader();
+
+		// readers may call this from any thread, a snapshot stays valid as long as it is held
+		[[nodiscard]] std::shared_ptr<const xcl::document> get_snapshot() const noexcept { return snapshot_.load(std::memory_order_acquire); }
+
+		// increased with every published snapshot, after the snapshot itself is published
+		[[nodiscard]] uint64_t get_generation() const noexcept { return generation_.load(std::memory_order_acquire); }
+
+		// parses the root file again and publishes the document, returns false when the parse failed
+		bool reload();
+
+		// reloads that published a snapshot, the first parse is not counted
+		[[nodiscard]] size_t get_reload_count() const noexcept { return reload_count_; }
+		[[nodiscard]] size_t get_failure_count() const noexcept { return failure_count_; }
+
+		// duration of the last reload, failed or not
+		[[nodiscard]] std::chrono::nanoseconds get_last_latency() const noexcept { return std::chrono::nanoseconds(last_latency_.load()); }
+
+		// message of the last failed reload, empty until a reload fails
+		[[nodiscard]] std::string get_last_error() const;
+
+		document_reloader& operator=(const document_reloader&) = delete;
+		document_reloader& operator=(document_reloader&&) = delete;
+
+		// caches the snapshot for a single reader thread, the current document costs one atomic load while nothing is published
+		class reader
+		{
+		public:
+			explicit reader(const document_reloader& reloader) : reloader_(reloader) {}
+
+			[[nodiscard]] const xcl::document& get()
+			{
+				if (const auto generation = reloader_.get_generation(); generation != generation_)
+				{
+					snapshot_ = reloader_.get_snapshot();
+					generation_ = generation;
+				}
+				return *snapshot_;
+			}
+
+		private:
+			const document_reloader& reloader_;
+			// snapshots are published from generation one on
+			uint64_t generation_{0};
+			std::shared_ptr<const xcl::document> snapshot_;
+		};
+
+	private:
+		typedef std::pair<std::filesystem::file_time_type, uintmax_t> file_stamp;
+
+		// the root and the files reachable through its imports, with their current stamps
+		[[nodiscard]] std::map<std::filesystem::path, file_stamp> stamp_files() const;
+		[[nodiscard]] bool is_changed() const;
+		[[nodiscard]] std::set<std::filesystem::path> get_watched_directories() const;
+		void publish(std::shared_ptr<const xcl::document> document);
+		void watch();
+
+		// how long the watcher waits for events before it checks whether it is stopped
+		static constexpr std::chrono::milliseconds watch_interval{100};
+
+		std::filesystem::path root_;
+		parser::document_parser parser_;
+		std::atomic<std::shared_ptr<const xcl::document>> snapshot_;
+		std::atomic<uint64_t> generation_{0};
+
+		std::atomic<size_t> reload_count_{0};
+		std::atomic<size_t> failure_count_{0};
+		std::atomic<int64_t> last_latency_{0};
+		mutable std::mutex error_mutex_;
+		std::string last_error_;
+
+		// reloads of the watcher and of the owner are serialized, the stamps are guarded by it as well
+		mutable std::mutex reload_mutex_;
+		std::map<std::filesystem::path, file_stamp> stamps_;
+
+		std::atomic<bool> is_stopping_{false};
+		std::thread watcher_;
+	};
+}
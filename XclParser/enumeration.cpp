@@ -4,34 +4,34 @@
 
 void xcl::types::enumeration::add_value(const std::string& name)
 {
-	values_.push_back(std::make_unique<xcl::objects::enumeration>(*this, name, values_.size()));
+	values_.push_back(name);
 }
 
-std::unique_ptr<xcl::objects::enumeration> xcl::types::enumeration::activate(const std::string& name) const
+xcl::value xcl::types::enumeration::activate(const std::string_view name) const
 {
-	for (const auto& value : values_)
+	for (size_t index = 0; index < values_.size(); ++index)
 	{
-		if (value->get_name() == name)
+		if (values_[index] == name)
 		{
-			return std::make_unique<xcl::objects::enumeration>(*value);
+			return { *this, static_cast<int>(index) };
 		}
 	}
-	throw xcl::errors::member_not_found_error(name, this->get_name());
+	throw xcl::errors::member_not_found_error(std::string(name), this->get_name());
 }
 
-std::unique_ptr<xcl::objects::object> xcl::types::enumeration::activate(const xcl::parser::token& token) const
+xcl::value xcl::types::enumeration::activate(const xcl::parser::token& token, std::pmr::memory_resource&) const
 {
 	if (token.get_type() != parser::identifier)
 		throw errors::unexpected_token_error(token);
 	return activate(token.get_text());
 }
 
-std::unique_ptr<xcl::objects::object> xcl::objects::enumeration::clone() const
+xcl::objects::object* xcl::objects::enumeration::clone(std::pmr::memory_resource& arena) const
 {
-	return std::make_unique<xcl::objects::enumeration>(*this);
+	return allocate_object<xcl::objects::enumeration>(arena, *this);
 }
 
 std::string xcl::objects::enumeration::to_string() const
 {
-	return name_;
+	return get_name();
 }
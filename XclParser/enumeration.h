@@ -19,13 +19,13 @@ namespace xcl::types
 
 		[[nodiscard]] size_t values_count() const { return values_.size(); }
 
-		[[nodiscard]] std::unique_ptr<xcl::objects::enumeration> activate(const std::string& name) const;
-		[[nodiscard]] std::unique_ptr<xcl::objects::object> activate(const xcl::parser::token&) const override;
+		[[nodiscard]] xcl::value activate(std::string_view name) const;
+		[[nodiscard]] xcl::value activate(const xcl::parser::token&, std::pmr::memory_resource& arena) const override;
 
-		[[nodiscard]] const std::vector<std::unique_ptr<xcl::objects::enumeration>>& get_values() const noexcept { return values_; }
+		[[nodiscard]] const std::vector<std::string>& get_values() const noexcept { return values_; }
 
 	private:
-		std::vector<std::unique_ptr<xcl::objects::enumeration>> values_;
+		std::vector<std::string> values_;
 	};
 }
 
@@ -34,18 +34,21 @@ namespace xcl::objects
 	class enumeration final : public object
 	{
 	public:
-		enumeration(const xcl::types::enumeration& type, std::string name, const int index) : object(type), index_(index), name_(std::move(name)) {}
+		enumeration(const xcl::types::enumeration& type, const int index) : object(type), index_(index) {}
 
 		[[nodiscard]] int get_index() const { return index_; }
 
-		[[nodiscard]] const std::string& get_name() const { return name_; }
+		// the name is shared with the type instead of being copied into every value
+		[[nodiscard]] const std::string& get_name() const { return static_cast<const xcl::types::enumeration&>(get_type()).get_values()[index_]; }
 
-		[[nodiscard]] std::unique_ptr<xcl::objects::object> clone() const override;
+		[[nodiscard]] xcl::objects::object* clone(std::pmr::memory_resource& arena) const override;
 
 		[[nodiscard]] std::string to_string() const override;
 
+	protected:
+		[[nodiscard]] size_t compute_hash() const noexcept override { return xcl::value(static_cast<const xcl::types::enumeration&>(get_type()), index_).get_hash(); }
+
 	private:
 		int index_;
-		std::string name_;
 	};
 }
@@ -0,0 +1,35 @@
+﻿#pragma once
+
+#include <string_view>
+
+#include "type.h"
+#include "value.h"
+
+namespace xcl::parser
+{
+	// receives the content of a document in the order it is parsed, none of the values are stored by the parser
+	// names stay valid for the life of the process, values are only valid during the call:
+	// the text of a string value is a view into the token, which a chunked or pipelined stream drops once it reads on
+	// and a list or section given for a field or a member of a container type is held by a scratch arena
+	class event_handler
+	{
+	public:
+		virtual ~event_handler() = default;
+
+		// types declared by the parsed source itself, the imported types are not reported
+		virtual void on_type_defined(const xcl::types::type&) {}
+
+		// a name defined again is reported again, the last definition is the one a document keeps
+		virtual void on_definition_begin(std::string_view, const xcl::types::type&) {}
+
+		// a field set in a section, the fields that are not set keep their defaults and are not reported
+		virtual void on_field(std::string_view, const xcl::value&) {}
+
+		virtual void on_list_value(const xcl::value&) {}
+
+		// the value of a definition that is neither a section nor a list
+		virtual void on_value(const xcl::value&) {}
+
+		virtual void on_definition_end(std::string_view, const xcl::types::type&) {}
+	};
+}
@@ -3,6 +3,7 @@
 #include <exception>
 #include <string>
 #include <format>
+#include <vector>
 
 #include "token.h"
 #include "type.h"
@@ -104,53 +105,137 @@ namespace xcl::errors
 		char character_;
 	};
 
-	class unexpected_token_error final : public xcl_exception
+	class token_error : public xcl_exception
 	{
 	public:
-		explicit unexpected_token_error(xcl::parser::token token) : token_(std::move(token)) {}
+		[[nodiscard]] xcl::parser::token get_token() const noexcept { return { type_, text_ }; }
+
+		// the position points into the tokenized source and is only meaningful while the source is alive
+		[[nodiscard]] const char* get_position() const noexcept { return position_; }
+
+		[[nodiscard]] bool is_located() const noexcept { return location_.line != 0; }
+		[[nodiscard]] const xcl::parser::text_location& get_location() const noexcept { return location_; }
+		void set_location(const xcl::parser::text_location& location) noexcept { location_ = location; }
+
+	protected:
+		// the token text is copied, since the error may outlive the tokenized source
+		explicit token_error(const xcl::parser::token& token) :
+			type_(token.get_type()),
+			text_(token.get_text()),
+			position_(token.get_text().data()) {}
+
+		[[nodiscard]] const std::string& get_text() const noexcept { return text_; }
+
+		[[nodiscard]] std::string format_location() const
+		{
+			return is_located() ? std::format(" at {}:{}", location_.line, location_.column) : std::string();
+		}
+
+	private:
+		xcl::parser::token_type type_;
+		std::string text_;
+		const char* position_;
+		xcl::parser::text_location location_{0, 0};
+	};
+
+	class unexpected_token_error final : public token_error
+	{
+	public:
+		explicit unexpected_token_error(const xcl::parser::token& token) : token_error(token) {}
 
 		[[nodiscard]] std::string get_message() const noexcept override
 		{
-			return std::format("Unexpected token `{}` found at {}:{}.", token_.get_text(), token_.get_line(), token_.get_column());
+			return std::format("Unexpected token `{}` found{}.", get_text(), format_location());
 		}
+	};
 
-		[[nodiscard]] const xcl::parser::token& get_token() const noexcept { return token_; }
+	class unexpected_end_of_tokens_error final : public token_error
+	{
+	public:
+		explicit unexpected_end_of_tokens_error(const xcl::parser::token& token) : token_error(token) {}
 
-	private:
-		xcl::parser::token token_;
+		[[nodiscard]] std::string get_message() const noexcept override
+		{
+			return std::format("Unexpected end with token `{}`{}.", get_text(), format_location());
+		}
 	};
 
-	class unexpected_end_of_tokens_error final : public xcl_exception
+	class type_mismatch_error final : public xcl_exception
 	{
 	public:
-		explicit unexpected_end_of_tokens_error(xcl::parser::token token) : token_(std::move(token)) {}
+		// the names are copied, since the error may outlive the document defining the types
+		type_mismatch_error(const xcl::types::type& given_type, const xcl::types::type& supported_type) :
+			given_type_(given_type.get_name()),
+			supported_type_(supported_type.get_name()) {}
+
+		[[nodiscard]] const std::string& get_given_type_name() const noexcept { return given_type_; }
+
+		[[nodiscard]] const std::string& get_supported_type_name() const noexcept { return supported_type_; }
 
 		[[nodiscard]] std::string get_message() const noexcept override
 		{
-			return std::format("Unexpected end with token `{}` at {}:{}.", token_.get_text(), token_.get_line(), token_.get_column());
+			return std::format("The type `{}` is given, while type `{}` was supported.", given_type_, supported_type_);
 		}
 
-		[[nodiscard]] const xcl::parser::token& get_token() const noexcept { return token_; }
+	private:
+		std::string given_type_, supported_type_;
+	};
+
+	class schema_mismatch_error final : public xcl_exception
+	{
+	public:
+		schema_mismatch_error(std::string type_name, std::vector<std::string> mismatches) :
+			type_name_(std::move(type_name)),
+			mismatches_(std::move(mismatches)) {}
+
+		[[nodiscard]] const std::string& get_type_name() const noexcept { return type_name_; }
+
+		// every difference found between the type and its binding, not only the first one
+		[[nodiscard]] const std::vector<std::string>& get_mismatches() const noexcept { return mismatches_; }
+
+		[[nodiscard]] std::string get_message() const noexcept override
+		{
+			auto message = std::format("The type `{}` does not match its binding.", type_name_);
+			for (const auto& mismatch : mismatches_)
+			{
+				message += ' ';
+				message += mismatch;
+			}
+			return message;
+		}
 
 	private:
-		xcl::parser::token token_;
+		std::string type_name_;
+		std::vector<std::string> mismatches_;
 	};
 
-	class type_mismatch_error final : public xcl_exception
+	class import_cycle_error final : public xcl_exception
 	{
 	public:
-		type_mismatch_error(const xcl::types::type& given_type, const xcl::types::type& supported_type) : given_type_(given_type), supported_type_(supported_type) {}
+		// the files of the cycle in import order, the first one is repeated at the end
+		explicit import_cycle_error(std::vector<std::string> files) : files_(std::move(files)) {}
 
-		[[nodiscard]] const xcl::types::type& get_given_type() const noexcept { return given_type_; }
+		[[nodiscard]] const std::vector<std::string>& get_files() const noexcept { return files_; }
 
-		[[nodiscard]] const xcl::types::type& get_supported_type() const noexcept { return supported_type_; }
+		// the location of the import closing the cycle, in the last file before the repeated one
+		[[nodiscard]] bool is_located() const noexcept { return location_.line != 0; }
+		[[nodiscard]] const xcl::parser::text_location& get_location() const noexcept { return location_; }
+		void set_location(const xcl::parser::text_location& location) noexcept { location_ = location; }
 
 		[[nodiscard]] std::string get_message() const noexcept override
 		{
-			return std::format("The type `{}` is given, while type `{}` was supported.", given_type_.get_name(), supported_type_.get_name());
+			std::string cycle;
+			for (const auto& file : files_)
+			{
+				cycle += cycle.empty() ? file : " -> " + file;
+			}
+			return is_located()
+				? std::format("The imports form a cycle: {} at {}:{}.", cycle, location_.line, location_.column)
+				: std::format("The imports form a cycle: {}.", cycle);
 		}
 
 	private:
-		const types::type& given_type_, & supported_type_;
+		std::vector<std::string> files_;
+		xcl::parser::text_location location_{0, 0};
 	};
 }
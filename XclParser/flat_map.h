@@ -0,0 +1,121 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory_resource>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace xcl
+{
+	// open addressing hash map from names to values, iterated in insertion order
+	// names and storage are allocated from the given arena, lookups never build a string
+	template <class T>
+	class ordered_flat_map
+	{
+	public:
+		typedef std::pair<std::string_view, T> value_type;
+		typedef typename std::pmr::vector<value_type>::const_iterator const_iterator;
+
+		explicit ordered_flat_map(std::pmr::memory_resource& arena) : arena_(&arena), entries_(&arena), slots_(&arena) {}
+
+		[[nodiscard]] const_iterator begin() const noexcept { return entries_.begin(); }
+		[[nodiscard]] const_iterator end() const noexcept { return entries_.end(); }
+		[[nodiscard]] size_t size() const noexcept { return entries_.size(); }
+		[[nodiscard]] bool empty() const noexcept { return entries_.empty(); }
+
+		[[nodiscard]] const_iterator find(const std::string_view name) const noexcept
+		{
+			if (slots_.empty())
+				return end();
+			const auto hash = hash_name(name);
+			for (auto position = hash & mask(); slots_[position].index != 0; position = (position + 1) & mask())
+			{
+				if (const auto& candidate = slots_[position]; candidate.hash == static_cast<uint32_t>(hash) && entries_[candidate.index - 1].first == name)
+					return begin() + (candidate.index - 1);
+			}
+			return end();
+		}
+
+		[[nodiscard]] bool contains(const std::string_view name) const noexcept { return find(name) != end(); }
+
+		// a new name is copied into the arena and appended, an existing name keeps its position
+		void insert_or_assign(const std::string_view name, const T& value)
+		{
+			if (const auto existing = find(name); existing != end())
+			{
+				entries_[existing - begin()].second = value;
+				return;
+			}
+			if ((entries_.size() + 1) * 2 > slots_.size())
+				rehash(slots_.empty() ? 16 : slots_.size() * 2);
+
+			entries_.emplace_back(store_name(name), value);
+			place(hash_name(name), static_cast<uint32_t>(entries_.size()));
+		}
+
+		// replaces count entries from first with the entries of other in their place, the names must stay unique
+		// when the names are the same only the values are assigned, otherwise the table is rebuilt
+		void splice(const size_t first, const size_t count, const ordered_flat_map& other)
+		{
+			if (count == other.size() && std::equal(other.begin(), other.end(), begin() + first, [](const auto& left, const auto& right) { return left.first == right.first; }))
+			{
+				for (size_t index = 0; index < count; ++index)
+					entries_[first + index].second = other.entries_[index].second;
+				return;
+			}
+
+			std::pmr::vector<value_type> entries(arena_);
+			entries.reserve(entries_.size() - count + other.size());
+			entries.insert(entries.end(), begin(), begin() + first);
+			for (const auto& [name, value] : other)
+				entries.emplace_back(store_name(name), value);
+			entries.insert(entries.end(), begin() + first + count, end());
+			entries_ = std::move(entries);
+			rehash(std::max<size_t>(16, std::bit_ceil(entries_.size() * 2)));
+		}
+
+	private:
+		struct slot
+		{
+			uint32_t hash;
+			// position of the entry plus one, zero marks an empty slot
+			uint32_t index;
+		};
+
+		[[nodiscard]] static size_t hash_name(const std::string_view name) noexcept { return std::hash<std::string_view>{}(name); }
+
+		[[nodiscard]] size_t mask() const noexcept { return slots_.size() - 1; }
+
+		void place(const size_t hash, const uint32_t index) noexcept
+		{
+			auto position = hash & mask();
+			while (slots_[position].index != 0)
+				position = (position + 1) & mask();
+			slots_[position] = { static_cast<uint32_t>(hash), index };
+		}
+
+		[[nodiscard]] std::string_view store_name(const std::string_view name) const
+		{
+			const auto text = static_cast<char*>(arena_->allocate(name.size(), alignof(char)));
+			std::memcpy(text, name.data(), name.size());
+			return { text, name.size() };
+		}
+
+		// the table is kept at most half full, so probe sequences stay short
+		void rehash(const size_t slot_count)
+		{
+			slots_.assign(slot_count, slot{});
+			for (uint32_t index = 0; index < entries_.size(); ++index)
+				place(hash_name(entries_[index].first), index + 1);
+		}
+
+		std::pmr::memory_resource* arena_;
+		std::pmr::vector<value_type> entries_;
+		std::pmr::vector<slot> slots_;
+	};
+}
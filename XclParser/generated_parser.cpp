@@ -0,0 +1,63 @@
+﻿#include "pch.h"
+#include "generated_parser.h"
+
+#include "boolean.h"
+#include "exception.h"
+#include "number.h"
+
+using namespace std;
+
+// the builtin types read the literals, so the generated parsers accept the same grammar as the generic one
+long xcl::generated::parse_integer(const parser::token& token)
+{
+	return types::number::get_instance()->activate(token, *pmr::null_memory_resource()).as_integer();
+}
+
+bool xcl::generated::parse_boolean(const parser::token& token)
+{
+	return types::boolean::get_instance()->activate(token, *pmr::null_memory_resource()).as_boolean();
+}
+
+std::string xcl::generated::parse_string(const parser::token& token)
+{
+	return token.parse_string_literal();
+}
+
+std::string_view xcl::generated::parse_field_name(parser::source_token_stream& tokens)
+{
+	binding_parser::expect(tokens, parser::identifier);
+	const auto name = tokens.current().get_text();
+	tokens.advance();
+
+	binding_parser::expect(tokens, parser::equals);
+	tokens.advance();
+
+	binding_parser::expect_token(tokens);
+	return name;
+}
+
+void xcl::generated::expect_scalar_value(parser::token_stream& tokens)
+{
+	binding_parser::expect(tokens, parser::equals);
+	tokens.advance();
+
+	binding_parser::expect_token(tokens);
+}
+
+void xcl::generated::skip_import(parser::token_stream& tokens)
+{
+	tokens.advance();
+
+	binding_parser::expect(tokens, parser::string_literal);
+	tokens.advance();
+}
+
+void xcl::generated::throw_member_not_found(const std::string_view name, const std::string_view type_name)
+{
+	throw errors::member_not_found_error(string(name), string(type_name));
+}
+
+std::string xcl::generated::format_type_mismatch(const std::string_view given_type, const std::string_view supported_type)
+{
+	return std::format("The type `{}` is given, while type `{}` was supported.", given_type, supported_type);
+}
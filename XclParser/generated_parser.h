@@ -0,0 +1,45 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "binding.h"
+#include "token_stream.h"
+
+// support for the parsers emitted by generate_parser, they are compiled against these functions
+// the generated parsers read from a source_token_stream, whose tokens stay valid as long as the source
+namespace xcl::generated
+{
+	// fnv-1a, the generator precomputes the hashes of the names and searches the seeds of the perfect hashes with it
+	[[nodiscard]] constexpr uint64_t hash_name(const std::string_view name, const uint64_t seed = 14695981039346656037ull) noexcept
+	{
+		auto result = seed;
+		for (const auto character : name)
+		{
+			result = (result ^ static_cast<unsigned char>(character)) * 1099511628211ull;
+		}
+		return result;
+	}
+
+	// the scalars are read the same way as by the builtin types
+	[[nodiscard]] long parse_integer(const parser::token& token);
+	[[nodiscard]] bool parse_boolean(const parser::token& token);
+	[[nodiscard]] std::string parse_string(const parser::token& token);
+
+	// syntax: <Identifier> =
+	// returns the name of the field, the stream is left on its value
+	[[nodiscard]] std::string_view parse_field_name(parser::source_token_stream& tokens);
+
+	// syntax: = <Value>
+	// the stream is left on the value
+	void expect_scalar_value(parser::token_stream& tokens);
+
+	// syntax: import <String Literal>
+	// the schema of a generated parser is compiled into it, so the imports of a data file are skipped
+	void skip_import(parser::token_stream& tokens);
+
+	[[noreturn]] void throw_member_not_found(std::string_view name, std::string_view type_name);
+
+	[[nodiscard]] std::string format_type_mismatch(std::string_view given_type, std::string_view supported_type);
+}
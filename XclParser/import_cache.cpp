@@ -0,0 +1,88 @@
+﻿#include "pch.h"
+#include "import_cache.h"
+
+#include <algorithm>
+#include <unordered_set>
+
+thread_local std::vector<xcl::import_cache::file_stamp>* xcl::import_cache::resolved_files_ = nullptr;
+
+std::shared_ptr<const xcl::document> xcl::import_cache::resolve(const std::filesystem::path& path, const std::function<xcl::document()>& parse)
+{
+	std::error_code error;
+	const auto key = std::filesystem::weakly_canonical(path, error).string();
+	const auto write_time = std::filesystem::last_write_time(path, error);
+	const auto size = error ? 0 : std::filesystem::file_size(path, error);
+	if (error)
+	{
+		// missing or unreadable files are not cached, parsing them reports the error
+		++misses_;
+		return std::make_shared<const xcl::document>(parse());
+	}
+
+	const auto importer_files = resolved_files_;
+	const auto add_to_importer = [importer_files](const std::vector<file_stamp>& files)
+	{
+		if (importer_files != nullptr)
+		{
+			importer_files->insert(importer_files->end(), files.begin(), files.end());
+		}
+	};
+
+	entry cached;
+	{
+		std::lock_guard lock(mutex_);
+		if (const auto found = entries_.find(key); found != entries_.end())
+		{
+			cached = found->second;
+		}
+	}
+	// the files are checked outside of the lock
+	if (cached.document != nullptr && is_current(cached.files))
+	{
+		++hits_;
+		add_to_importer(cached.files);
+		return cached.document;
+	}
+
+	// parsed outside of the lock, imports of the parsed file are resolved through the cache as well and record their files
+	++misses_;
+	entry parsed{ { { key, write_time, size } }, nullptr };
+	resolved_files_ = &parsed.files;
+	try
+	{
+		parsed.document = std::make_shared<const xcl::document>(parse());
+	}
+	catch (...)
+	{
+		resolved_files_ = importer_files;
+		throw;
+	}
+	resolved_files_ = importer_files;
+
+	// a file imported along several paths is checked once
+	std::unordered_set<std::string> keys;
+	std::erase_if(parsed.files, [&keys](const file_stamp& file) { return !keys.insert(file.key).second; });
+	add_to_importer(parsed.files);
+
+	auto document = parsed.document;
+	std::lock_guard lock(mutex_);
+	entries_.insert_or_assign(key, std::move(parsed));
+	return document;
+}
+
+void xcl::import_cache::clear()
+{
+	std::lock_guard lock(mutex_);
+	entries_.clear();
+}
+
+bool xcl::import_cache::is_current(const std::vector<file_stamp>& files)
+{
+	return std::ranges::all_of(files, [](const file_stamp& file)
+	{
+		std::error_code error;
+		const auto write_time = std::filesystem::last_write_time(file.key, error);
+		const auto size = error ? 0 : std::filesystem::file_size(file.key, error);
+		return !error && write_time == file.write_time && size == file.size;
+	});
+}
@@ -0,0 +1,53 @@
+﻿#pragma once
+
+#include <atomic>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "document.h"
+
+namespace xcl
+{
+	// parsed imports shared by every document importing the same file
+	// an entry is parsed again once the size or modification time of its file, or of any file it imports directly or not, changes
+	class import_cache
+	{
+	public:
+		[[nodiscard]] std::shared_ptr<const xcl::document> resolve(const std::filesystem::path& path, const std::function<xcl::document()>& parse);
+
+		void clear();
+
+		[[nodiscard]] size_t get_hits() const noexcept { return hits_; }
+		[[nodiscard]] size_t get_misses() const noexcept { return misses_; }
+
+	private:
+		struct file_stamp
+		{
+			std::string key;
+			std::filesystem::file_time_type write_time;
+			uintmax_t size;
+		};
+
+		struct entry
+		{
+			// the file itself first, then the files it imports, since the document links the documents parsed from them
+			std::vector<file_stamp> files;
+			std::shared_ptr<const xcl::document> document;
+		};
+
+		[[nodiscard]] static bool is_current(const std::vector<file_stamp>& files);
+
+		// the files read by the parse this thread is resolving an import for, the imports it resolves add their own files
+		static thread_local std::vector<file_stamp>* resolved_files_;
+
+		std::mutex mutex_;
+		std::unordered_map<std::string, entry> entries_;
+		std::atomic<size_t> hits_{0};
+		std::atomic<size_t> misses_{0};
+	};
+}
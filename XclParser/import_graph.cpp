@@ -0,0 +1,80 @@
+﻿#include "pch.h"
+#include "import_graph.h"
+
+#include <algorithm>
+
+#include "exception.h"
+#include "mapped_file.h"
+
+using namespace std;
+
+std::vector<std::string> xcl::parser::scan_imports(const std::string_view source)
+{
+	constexpr string_view blank = " \t\r";
+	constexpr string_view keyword = "import";
+
+	vector<string> result;
+	for (size_t start = 0; start < source.size();)
+	{
+		auto end = source.find('\n', start);
+		if (end == string_view::npos)
+			end = source.size();
+
+		auto line = source.substr(start, end - start);
+		line.remove_prefix(min(line.find_first_not_of(blank), line.size()));
+		if (line.starts_with(keyword) && line.size() > keyword.size() && blank.find(line[keyword.size()]) != string_view::npos)
+		{
+			line.remove_prefix(keyword.size());
+			line.remove_prefix(min(line.find_first_not_of(blank), line.size()));
+			if (const auto closing = line.find('"', 1); line.starts_with('"') && closing != string_view::npos)
+			{
+				result.emplace_back(line.substr(1, closing - 1));
+			}
+		}
+		start = end + 1;
+	}
+	return result;
+}
+
+xcl::parser::import_graph::import_graph(const std::filesystem::path& root)
+{
+	vector<string> chain;
+	visit(root, chain);
+
+	// the root has the greatest height and is parsed by the caller
+	if (!levels_.empty())
+	{
+		levels_.pop_back();
+	}
+}
+
+size_t xcl::parser::import_graph::visit(const std::filesystem::path& path, std::vector<std::string>& chain)
+{
+	auto key = std::filesystem::weakly_canonical(path).string();
+	if (const auto visited = heights_.find(key); visited != heights_.end())
+	{
+		return visited->second;
+	}
+	if (const auto cycle = ranges::find(chain, key); cycle != chain.end())
+	{
+		vector files(cycle, chain.end());
+		files.push_back(key);
+		throw errors::import_cycle_error(move(files));
+	}
+
+	chain.push_back(key);
+	size_t height = 0;
+	for (const auto& name : scan_imports(mapped_file(path).get_text()))
+	{
+		height = max(height, visit(path.parent_path() / name, chain) + 1);
+	}
+	chain.pop_back();
+
+	if (levels_.size() <= height)
+	{
+		levels_.resize(height + 1);
+	}
+	levels_[height].push_back(path);
+	heights_.emplace(move(key), height);
+	return height;
+}
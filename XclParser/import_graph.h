@@ -0,0 +1,30 @@
+﻿#pragma once
+
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace xcl::parser
+{
+	// names of the files imported by the source, found by a scan of its `import "<name>"` lines
+	[[nodiscard]] std::vector<std::string> scan_imports(std::string_view source);
+
+	// the files reachable through imports from a root file, a file imported along several paths is a single node
+	class import_graph
+	{
+	public:
+		explicit import_graph(const std::filesystem::path& root);
+
+		// imported files grouped so that a file only imports files of earlier levels, the root itself is not included
+		[[nodiscard]] const std::vector<std::vector<std::filesystem::path>>& get_levels() const noexcept { return levels_; }
+
+	private:
+		size_t visit(const std::filesystem::path& path, std::vector<std::string>& chain);
+
+		// height of every visited file, leaves have a height of zero
+		std::unordered_map<std::string, size_t> heights_;
+		std::vector<std::vector<std::filesystem::path>> levels_;
+	};
+}
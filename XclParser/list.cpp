@@ -5,14 +5,14 @@
 
 using namespace std;
 
-std::unique_ptr<xcl::objects::list> xcl::types::list::activate() const
+xcl::objects::list* xcl::types::list::activate(std::pmr::memory_resource& arena) const
 {
-	return make_unique<xcl::objects::list>(*this);
+	return objects::allocate_object<xcl::objects::list>(arena, *this, arena);
 }
 
-std::unique_ptr<xcl::objects::object> xcl::types::list::activate(const xcl::parser::token&) const
+xcl::value xcl::types::list::activate(const xcl::parser::token&, std::pmr::memory_resource& arena) const
 {
-	return activate();
+	return xcl::value(*activate(arena));
 }
 
 std::string xcl::objects::list::to_string() const
@@ -21,28 +21,40 @@ std::string xcl::objects::list::to_string() const
 
 	for (const auto& value : members_)
 	{
-		result += value->to_string() + ", ";
+		result += value.to_string() + ", ";
 	}
 	result += " ]";
 
 	return result;
 }
 
-std::unique_ptr<xcl::objects::object> xcl::objects::list::clone() const
+xcl::objects::object* xcl::objects::list::clone(std::pmr::memory_resource& arena) const
 {
-	auto result = make_unique<list>(dynamic_cast<const xcl::types::list&>(get_type()));
+	auto result = allocate_object<list>(arena, dynamic_cast<const xcl::types::list&>(get_type()), arena);
+	result->members_.reserve(members_.size());
 	for (const auto& value : members_)
 	{
-		result->add_value(value->clone());
+		result->members_.push_back(value.clone(arena));
 	}
 	return result;
 }
 
-void xcl::objects::list::add_value(std::unique_ptr<xcl::objects::object> value)
+void xcl::objects::list::add_value(const xcl::value& value)
 {
-	if (const auto& supported_type = dynamic_cast<const types::list&>(get_type()).get_contained_type(); value->get_type().get_name() != supported_type.get_name())
+	if (const auto& supported_type = static_cast<const types::list&>(get_type()).get_contained_type(); value.get_type().get_name() != supported_type.get_name())
 	{
-		throw xcl::errors::type_mismatch_error(value->get_type(), supported_type);
+		throw xcl::errors::type_mismatch_error(value.get_type(), supported_type);
 	}
-	members_.push_back(move(value));
+	members_.push_back(value);
+	reset_hash();
+}
+
+size_t xcl::objects::list::compute_hash() const noexcept
+{
+	auto result = get_type().get_name_hash();
+	for (const auto& member : members_)
+	{
+		result = hash_combine(result, member.get_hash());
+	}
+	return result;
 }
@@ -15,9 +15,9 @@ namespace xcl::types
 	public:
 		explicit list(const std::string& name, const type& type) : type(name), type_(type) {}
 
-		[[nodiscard]] std::unique_ptr<xcl::objects::list> activate() const;
+		[[nodiscard]] xcl::objects::list* activate(std::pmr::memory_resource& arena) const;
 
-		[[nodiscard]] std::unique_ptr<xcl::objects::object> activate(const xcl::parser::token&) const override;
+		[[nodiscard]] xcl::value activate(const xcl::parser::token&, std::pmr::memory_resource& arena) const override;
 
 		[[nodiscard]] const type& get_contained_type() const noexcept { return type_; }
 
@@ -31,17 +31,20 @@ namespace xcl::objects
 	class list final : public object
 	{
 	public:
-		explicit list(const xcl::types::list& type) : object(type) {}
+		list(const xcl::types::list& type, std::pmr::memory_resource& arena) : object(type), members_(&arena) {}
 
 		[[nodiscard]] std::string to_string() const override;
 
-		[[nodiscard]] std::unique_ptr<xcl::objects::object> clone() const override;
+		[[nodiscard]] xcl::objects::object* clone(std::pmr::memory_resource& arena) const override;
 
-		void add_value(std::unique_ptr<xcl::objects::object> value);
+		void add_value(const xcl::value& value);
 
-		[[nodiscard]] const std::vector<std::unique_ptr < xcl::objects::object>>& get_values() const noexcept { return members_; }
+		[[nodiscard]] const std::pmr::vector<xcl::value>& get_values() const noexcept { return members_; }
+
+	protected:
+		[[nodiscard]] size_t compute_hash() const noexcept override;
 
 	private:
-		std::vector<std::unique_ptr<xcl::objects::object>> members_;
+		std::pmr::vector<xcl::value> members_;
 	};
 }
@@ -0,0 +1,111 @@
+﻿#include "pch.h"
+#include "mapped_file.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "exception.h"
+
+using namespace std;
+
+#ifdef _WIN32
+
+xcl::mapped_file::mapped_file(const std::filesystem::path& path)
+{
+	// sharing delete lets a writer rename a new version over the file while the old one is mapped
+	const auto file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		throw errors::xcl_runtime_error(std::format("The file `{}` could not be opened.", path.string()));
+	}
+
+	LARGE_INTEGER size{};
+	if (!GetFileSizeEx(file, &size))
+	{
+		CloseHandle(file);
+		throw errors::xcl_runtime_error(std::format("The file `{}` could not be read.", path.string()));
+	}
+
+	// empty files can not be mapped
+	if (size.QuadPart > 0)
+	{
+		const auto mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mapping != nullptr)
+		{
+			data_ = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+			// the view keeps the mapping alive
+			CloseHandle(mapping);
+		}
+		if (data_ == nullptr)
+		{
+			CloseHandle(file);
+			throw errors::xcl_runtime_error(std::format("The file `{}` could not be mapped.", path.string()));
+		}
+		size_ = static_cast<size_t>(size.QuadPart);
+	}
+	CloseHandle(file);
+}
+
+xcl::mapped_file::~mapped_file()
+{
+	if (data_ != nullptr)
+	{
+		UnmapViewOfFile(data_);
+	}
+}
+
+#else
+
+xcl::mapped_file::mapped_file(const std::filesystem::path& path)
+{
+	const auto file = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (file == -1)
+	{
+		throw errors::xcl_runtime_error(std::format("The file `{}` could not be opened.", path.string()));
+	}
+
+	struct stat status{};
+	if (fstat(file, &status) == -1)
+	{
+		close(file);
+		throw errors::xcl_runtime_error(std::format("The file `{}` could not be read.", path.string()));
+	}
+
+	// empty files can not be mapped
+	if (status.st_size > 0)
+	{
+		const auto data = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+		if (data == MAP_FAILED)
+		{
+			close(file);
+			throw errors::xcl_runtime_error(std::format("The file `{}` could not be mapped.", path.string()));
+		}
+		madvise(data, static_cast<size_t>(status.st_size), MADV_SEQUENTIAL);
+		data_ = static_cast<const char*>(data);
+		size_ = static_cast<size_t>(status.st_size);
+	}
+	// the mapping stays valid after the descriptor is closed
+	close(file);
+}
+
+xcl::mapped_file::~mapped_file()
+{
+	if (data_ != nullptr)
+	{
+		munmap(const_cast<char*>(data_), size_);
+	}
+}
+
+#endif
+
+xcl::mapped_file::mapped_file(mapped_file&& other) noexcept : data_(other.data_), size_(other.size_)
+{
+	other.data_ = nullptr;
+	other.size_ = 0;
+}
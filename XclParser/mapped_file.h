@@ -0,0 +1,26 @@
+﻿#pragma once
+
+#include <filesystem>
+#include <string_view>
+
+namespace xcl
+{
+	// read-only memory mapping of a whole file, the text stays valid as long as the mapping is alive
+	class mapped_file
+	{
+	public:
+		explicit mapped_file(const std::filesystem::path& path);
+		mapped_file(const mapped_file&) = delete;
+		mapped_file(mapped_file&& other) noexcept;
+		~mapped_file();
+
+		[[nodiscard]] std::string_view get_text() const noexcept { return { data_, size_ }; }
+
+		mapped_file& operator=(const mapped_file&) = delete;
+		mapped_file& operator=(mapped_file&&) = delete;
+
+	private:
+		const char* data_{nullptr};
+		size_t size_{0};
+	};
+}
@@ -1,26 +1,32 @@
 ﻿#include "pch.h"
 
+#include <charconv>
+
 #include "number.h"
 #include "exception.h"
 #include "token.h"
 
 std::shared_ptr<xcl::types::number> xcl::types::number::instance_ = std::make_shared<xcl::types::number>();
 
-std::unique_ptr<xcl::objects::number> xcl::types::number::activate(long number) const noexcept
+xcl::value xcl::types::number::activate(const long number) const noexcept
 {
-	return std::make_unique<xcl::objects::number>(*this, number);
+	return { *this, number };
 }
 
-std::unique_ptr<xcl::objects::object> xcl::types::number::activate(const xcl::parser::token& token) const
+xcl::value xcl::types::number::activate(const xcl::parser::token& token, std::pmr::memory_resource&) const
 {
 	if (token.get_type() != parser::number_literal)
 		throw errors::unexpected_token_error(token);
-	return activate(stol(token.get_text()));
+	const auto text = token.get_text();
+	long value{};
+	if (const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value); error != std::errc{} || end != text.data() + text.size())
+		throw errors::unexpected_token_error(token);
+	return activate(value);
 }
 
-std::unique_ptr<xcl::objects::object> xcl::objects::number::clone() const
+xcl::objects::object* xcl::objects::number::clone(std::pmr::memory_resource& arena) const
 {
-	return std::make_unique<xcl::objects::number>(*this);
+	return allocate_object<xcl::objects::number>(arena, *this);
 }
 
 std::string xcl::objects::number::to_string() const
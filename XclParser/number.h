@@ -17,9 +17,9 @@ namespace xcl::types
 	public:
 		number() : type("int") {}
 
-		[[nodiscard]] std::unique_ptr<xcl::objects::number> activate(long number) const noexcept;
+		[[nodiscard]] xcl::value activate(long number) const noexcept;
 
-		[[nodiscard]] std::unique_ptr<xcl::objects::object> activate(const xcl::parser::token&) const override;
+		[[nodiscard]] xcl::value activate(const xcl::parser::token&, std::pmr::memory_resource& arena) const override;
 
 		bool is_custom_type() override { return false; }
 
@@ -39,10 +39,13 @@ namespace xcl::objects
 
 		[[nodiscard]] long get_value() const { return value_; }
 
-		[[nodiscard]] std::unique_ptr<xcl::objects::object> clone() const override;
+		[[nodiscard]] xcl::objects::object* clone(std::pmr::memory_resource& arena) const override;
 
 		[[nodiscard]] std::string to_string() const override;
 
+	protected:
+		[[nodiscard]] size_t compute_hash() const noexcept override { return xcl::value(static_cast<const xcl::types::number&>(get_type()), value_).get_hash(); }
+
 	private:
 		long value_;
 	};
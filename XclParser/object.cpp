@@ -1,2 +1,16 @@
 ﻿#include "pch.h"
 #include "object.h"
+
+#include <algorithm>
+
+size_t xcl::objects::object::get_hash() const noexcept
+{
+	auto hash = hash_.load(std::memory_order_relaxed);
+	if (hash == 0)
+	{
+		// zero marks a hash that is not computed yet
+		hash = std::max<size_t>(compute_hash(), 1);
+		hash_.store(hash, std::memory_order_relaxed);
+	}
+	return hash;
+}
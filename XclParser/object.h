@@ -1,5 +1,8 @@
 ﻿#pragma once
 
+#include <atomic>
+#include <memory_resource>
+
 #include "type.h"
 
 namespace xcl::objects
@@ -7,14 +10,18 @@ namespace xcl::objects
 	class object
 	{
 	public:
-		object(const object&) = default;
-		object(object&& other) = default;
+		object(const object& other) : type_(other.type_), hash_(other.hash_.load(std::memory_order_relaxed)) {}
+		object(object&& other) noexcept : type_(other.type_), hash_(other.hash_.load(std::memory_order_relaxed)) {}
 		virtual ~object() = default;
 
 		[[nodiscard]] const xcl::types::type& get_type() const { return type_; }
 		[[nodiscard]] virtual std::string to_string() const = 0;
 
-		[[nodiscard]] virtual std::unique_ptr<xcl::objects::object> clone() const = 0;
+		// structural hash, the same as the hash of the value viewing the object
+		// a container computes it once and keeps it until it is changed, so comparing unchanged documents does not walk them
+		[[nodiscard]] size_t get_hash() const noexcept;
+
+		[[nodiscard]] virtual xcl::objects::object* clone(std::pmr::memory_resource& arena) const = 0;
 
 		object& operator=(object&& other) noexcept = delete;
 		object& operator=(const object& other) noexcept = delete;
@@ -22,7 +29,20 @@ namespace xcl::objects
 	protected:
 		explicit object(const xcl::types::type& type) : type_(type) {}
 
+		[[nodiscard]] virtual size_t compute_hash() const noexcept = 0;
+
+		void reset_hash() noexcept { hash_.store(0, std::memory_order_relaxed); }
+
 	private:
 		const xcl::types::type& type_;
+		// zero until computed, readers of a published document may compute it concurrently with the same result
+		mutable std::atomic<size_t> hash_{0};
 	};
+
+	// objects live in the arena of their document and are released with it, their destructors are never run
+	template <class T, class... Args>
+	[[nodiscard]] T* allocate_object(std::pmr::memory_resource& arena, Args&&... args)
+	{
+		return std::pmr::polymorphic_allocator<>(&arena).new_object<T>(std::forward<Args>(args)...);
+	}
 }
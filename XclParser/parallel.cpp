@@ -0,0 +1,64 @@
+﻿#include "pch.h"
+#include "parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+void xcl::parallel_for(const size_t count, const std::function<void(size_t)>& body)
+{
+	const auto thread_count = std::min<size_t>(count, std::max(1u, std::thread::hardware_concurrency()));
+	if (thread_count <= 1)
+	{
+		for (size_t index = 0; index < count; ++index)
+			body(index);
+		return;
+	}
+
+	std::atomic<size_t> next{0};
+	std::mutex error_mutex;
+	std::exception_ptr error;
+
+	const auto worker = [&]
+	{
+		for (auto index = next++; index < count; index = next++)
+		{
+			try
+			{
+				body(index);
+			}
+			catch (...)
+			{
+				std::lock_guard lock(error_mutex);
+				if (!error)
+					error = std::current_exception();
+				next = count;
+			}
+		}
+	};
+
+	std::vector<std::thread> threads;
+	threads.reserve(thread_count - 1);
+	try
+	{
+		for (size_t i = 1; i < thread_count; ++i)
+			threads.emplace_back(worker);
+	}
+	catch (...)
+	{
+		// the started threads use the locals of this frame, they are stopped and joined before the error leaves it
+		next = count;
+		for (auto& thread : threads)
+			thread.join();
+		throw;
+	}
+	worker();
+	for (auto& thread : threads)
+		thread.join();
+
+	if (error)
+		std::rethrow_exception(error);
+}
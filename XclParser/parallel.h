@@ -0,0 +1,11 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <functional>
+
+namespace xcl
+{
+	// runs body for every index in [0, count) on up to one thread per core
+	// the first exception thrown by a body is rethrown once all threads are done
+	void parallel_for(size_t count, const std::function<void(size_t)>& body);
+}
@@ -4,639 +4,942 @@
 
 #include <typeindex>
 #include <algorithm>
+#include <optional>
 #include <ranges>
+#include <thread>
 
 #include "token.h"
 #include "exception.h"
 #include "document.h"
+#include "import_graph.h"
 #include "enumeration.h"
 #include "list.h"
+#include "mapped_file.h"
+#include "parallel.h"
 #include "section.h"
+#include "symbol_table.h"
+#include "xcl_string.h"
 
 using namespace std;
 using namespace xcl::parser;
 
-constexpr auto test = "hello";
+namespace
+{
+	// the files whose imports this thread is parsing, from the outermost one in
+	thread_local vector<string> import_chain;
 
-constexpr string_view keywords[] = {
-	"import",
-	"section",
-	"default",
-	"required",
-	"enum",
-	"list",
-};
-
-constexpr string_view operators[] = {
-	"{",
-	"}",
-	"=",
-	",",
-};
-
-inline bool is_keyword(const string& input)
-{
-	return ranges::any_of(keywords, keywords + size(keywords), [input](const string_view& keyword)
+	// holds a file in the chain while it is parsed, importing a file that is already in the chain is a cycle
+	class import_chain_entry
+	{
+	public:
+		explicit import_chain_entry(const filesystem::path& path)
 		{
-			return keyword == input;
-		});
+			error_code error;
+			auto key = filesystem::weakly_canonical(path, error).string();
+			if (error)
+			{
+				key = path.string();
+			}
+			if (const auto cycle = ranges::find(import_chain, key); cycle != import_chain.end())
+			{
+				vector files(cycle, import_chain.end());
+				files.push_back(std::move(key));
+				throw xcl::errors::import_cycle_error(std::move(files));
+			}
+			import_chain.push_back(std::move(key));
+		}
+
+		import_chain_entry(const import_chain_entry&) = delete;
+		import_chain_entry& operator=(const import_chain_entry&) = delete;
+
+		~import_chain_entry()
+		{
+			import_chain.pop_back();
+		}
+	};
 }
 
-inline void document_parser::expect_token(const std::vector<token>& tokens, tokens_iter& token_iter)
+constexpr auto test = "hello";
+
+inline void document_parser::expect_token(token_stream& tokens)
 {
-	while (token_iter != tokens.end() && token_iter->get_type() == whitespace) { ++token_iter; }
-	if (token_iter == tokens.end())
+	if (tokens.at_end())
 	{
-		throw errors::unexpected_end_of_tokens_error(*(token_iter - 1));
+		throw errors::unexpected_end_of_tokens_error(tokens.current());
 	}
 }
 
-inline void document_parser::expect_token_skip_new_line(const std::vector<token>& tokens, tokens_iter& token_iter)
+inline void document_parser::expect_token_skip_new_line(token_stream& tokens)
 {
-	while (token_iter != tokens.end() && (token_iter->get_type() == whitespace || token_iter->get_type() == new_line)) { ++token_iter; }
-	if (token_iter == tokens.end())
+	while (!tokens.at_end() && tokens.current().get_type() == new_line) { tokens.advance(); }
+	if (tokens.at_end())
 	{
-		throw errors::unexpected_end_of_tokens_error(*(token_iter - 1));
+		throw errors::unexpected_end_of_tokens_error(tokens.current());
 	}
 }
 
-inline void document_parser::expect_token_of_type(const std::vector<token>& tokens, tokens_iter& token_iter, const token_type expected_type)
+inline void document_parser::expect_token_of_type(token_stream& tokens, const token_type expected_type)
 {
 	if (expected_type != new_line)
 	{
-		expect_token_skip_new_line(tokens, token_iter);
+		expect_token_skip_new_line(tokens);
 	}
 	else
 	{
-		expect_token(tokens, token_iter);
+		expect_token(tokens);
 	}
-	if (token_iter->get_type() != expected_type)
+	if (tokens.current().get_type() != expected_type)
 	{
-		throw errors::unexpected_token_error(*token_iter);
+		throw errors::unexpected_token_error(tokens.current());
 	}
 }
 
-void tokenizer::initialize()
+tokens_vector tokenizer::tokenize(std::istream& input) const
 {
-	type_map_[' '] = whitespace;
-	type_map_['\t'] = whitespace;
-	type_map_['\r'] = whitespace;
-	type_map_['\n'] = new_line;
-
-	for (char c = 'a'; c <= 'z'; c++)
-		type_map_[c] = identifier;
-
-	for (char c = 'A'; c <= 'Z'; c++)
-		type_map_[c] = identifier;
+	auto source = make_shared<const string>(istreambuf_iterator<char>(input), istreambuf_iterator<char>());
+	auto result = tokenize(string_view(*source));
+	result.hold_source(move(source));
+	return result;
+}
 
-	for (char c = '0'; c <= '9'; c++)
-		type_map_[c] = number_literal;
+tokens_vector tokenizer::tokenize(const std::string_view input) const
+{
+	tokens_vector result(input);
+	for (source_token_stream tokens(input); !tokens.at_end(); tokens.advance())
+	{
+		result.add_token(tokens.current());
+	}
+	return result;
+}
 
-	type_map_['\"'] = string_literal;
+void document_parser::initialize(const import_resolver_fn& import_resolver)
+{
+	import_resolver_ = import_resolver;
+}
 
-	type_map_['{'] = operator_symbol;
-	type_map_['}'] = operator_symbol;
-	type_map_['='] = operator_symbol;
-	type_map_[','] = operator_symbol;
+xcl::document document_parser::parse(const tokens_vector& tokens, const bool is_imported) const
+{
+	vector_token_stream stream(tokens);
+	return parse(stream, is_imported);
 }
 
-std::vector<token> tokenizer::tokenize(std::istream& input) const
+xcl::document document_parser::parse(std::istream& input, const bool is_imported) const
 {
-	vector<token> result;
+	chunked_token_stream stream(input);
+	return parse(stream, is_imported);
+}
 
-	char current_char{};
-	string current_token;
-	token_type current_type{};
-	int line = 1, column = 1;
+xcl::document document_parser::parse_pipelined(std::istream& input, const bool is_imported) const
+{
+	pipelined_token_stream stream(input);
+	return parse(stream, is_imported);
+}
 
-	while (input.get(current_char))
+xcl::document document_parser::parse_file(const std::filesystem::path& path, const bool is_imported) const
+{
+	if (import_resolver_ == nullptr && !is_imported)
 	{
-		if (current_token.empty())
-		{
-			update_current_type(current_char, current_type);
-		}
+		preload_imports(path);
+	}
 
-		if (process_current_char(result, current_type, current_char, current_token, line, column) == false)
-		{
-			update_current_type(current_char, current_type);
+	// an imported file is entered by parse_import
+	optional<import_chain_entry> entry;
+	if (!is_imported)
+	{
+		entry.emplace(path);
+	}
 
-			if (process_current_char(result, current_type, current_char, current_token, line, column) == false)
-			{
-				throw xcl::errors::invalid_character_error(current_char);
-			}
-		}
+	const mapped_file file(path);
+	const auto file_parser = make_file_parser(path);
+	if (file.get_text().size() >= parallel_file_size)
+	{
+		return file_parser.parse_parallel(file.get_text(), is_imported);
 	}
+	source_token_stream tokens(file.get_text());
+	return file_parser.parse(tokens, is_imported);
+}
 
-	if (!current_token.empty())
+void document_parser::parse_file(const std::filesystem::path& path, event_handler& handler) const
+{
+	if (import_resolver_ == nullptr)
 	{
-		result.emplace_back(current_type, line, column, current_token);
+		preload_imports(path);
 	}
 
-	return result;
+	const import_chain_entry entry(path);
+	const mapped_file file(path);
+	source_token_stream tokens(file.get_text());
+	make_file_parser(path).parse(tokens, handler);
 }
 
-void tokenizer::update_current_type(const char& current_char, token_type& current_type) const
+document_parser document_parser::make_file_parser(const std::filesystem::path& path) const
 {
-	if (type_map_.contains(current_char))
+	document_parser result(*this);
+	if (import_resolver_ == nullptr)
 	{
-		current_type = type_map_.at(current_char);
+		result.import_resolver_ = [this, directory = path.parent_path()](const std::string& name)
+		{
+			return parse_import(directory / name);
+		};
 	}
-	else
+	return result;
+}
+
+std::shared_ptr<const xcl::document> document_parser::parse_import(const std::filesystem::path& path) const
+{
+	// the preloaded imports are checked for cycles by the import graph, imports found while parsing are checked here
+	const import_chain_entry entry(path);
+	return import_cache_->resolve(path, [this, &path] { return parse_file(path, true); });
+}
+
+void document_parser::preload_imports(const std::filesystem::path& path) const
+{
+	// every level only depends on earlier ones, so its files find their own imports in the cache
+	for (const import_graph graph(path); const auto& level : graph.get_levels())
 	{
-		throw xcl::errors::invalid_character_error(current_char);
+		parallel_for(level.size(), [this, &level](const size_t index) { (void)parse_import(level[index]); });
 	}
 }
 
-bool tokenizer::process_current_char(vector<token>& tokens, token_type current_type, const char& current_char, string& current_token, int& line, int& column) const
+xcl::document document_parser::parse(token_stream& tokens, const bool is_imported) const
 {
-	switch (current_type)
+	xcl::document result(is_imported);
+	parse_statements(result, tokens);
+
+	if (!is_imported)
 	{
-	case whitespace:
+		check_required_definitions(result);
+	}
+
+	return result;
+}
+
+void document_parser::parse(token_stream& tokens, event_handler& handler) const
+{
+	// the document only holds the declarations and the imports, which the definitions are read with
+	xcl::document scope(false);
+	event_state events{ handler, {}, {}, {} };
+	parse_statements(scope, tokens, &events);
+
+	// a required value may also be defined by an import
+	scope.for_each_required_definition([&scope, &events](const xcl::symbol symbol, const types::type&)
 	{
-		if (type_map_.at(current_char) != whitespace)
+		if (const auto name = symbol_table::get_instance().get_name(symbol); !events.defined.contains(symbol) && scope.find_data(name) == nullptr)
 		{
-			tokens.emplace_back(whitespace, line, column, current_token);
-			current_token.clear();
-			column++;
-			return false;
+			throw errors::xcl_runtime_error(std::format("The required value `{}` is not defined.", name));
 		}
-		current_token.push_back(current_char);
-		column++;
-		return true;
-	}
-	case new_line:
+	});
+}
+
+xcl::document document_parser::parse_parallel(const std::string_view source, const bool is_imported) const
+{
+	const auto runs = scan_statement_runs(source);
+	if (!runs)
 	{
-		tokens.emplace_back(new_line, line, column, current_token);
-		line++;
-		column = 1;
-		return true;
+		// malformed sources are left to the sequential parser to report
+		source_token_stream tokens(source);
+		return parse(tokens, is_imported);
 	}
-	case string_literal:
+
+	xcl::document result(is_imported);
+	for (const auto& run : *runs)
 	{
-		current_token.push_back(current_char);
-		column++;
-		if (current_token.size() > 1 && type_map_.contains(current_char) && type_map_.at(current_char) == string_literal)
+		const auto& statements = run.statements;
+		if (run.is_declaration || run.end - run.begin < 2 * parallel_chunk_size)
 		{
-			tokens.emplace_back(string_literal, line, column, current_token);
-			current_token.clear();
+			source_token_stream tokens(source.substr(0, run.end), run.begin);
+			parse_statements(result, tokens);
+			continue;
 		}
-		return true;
-	}
-	case number_literal:
-	{
-		if (type_map_.at(current_char) == number_literal)
+
+		// chunk boundaries are statement starts, so every chunk is a sequence of whole data definitions
+		const auto chunk_size = max(parallel_chunk_size, (run.end - run.begin) / (4 * max(1u, thread::hardware_concurrency())));
+		vector<pair<size_t, size_t>> chunks;
+		for (size_t statement = 0; statement < statements.size();)
 		{
-			current_token.push_back(current_char);
-			column++;
-			return true;
+			const auto begin = chunks.empty() ? run.begin : statements[statement];
+			const auto next = lower_bound(statements.begin() + statement, statements.end(), begin + chunk_size);
+			statement = next - statements.begin();
+			chunks.emplace_back(begin, next == statements.end() ? run.end : *next);
 		}
-		tokens.emplace_back(number_literal, line, column, current_token);
-		current_token.clear();
-		return false;
-	}
-	case identifier:
-	{
-		if (type_map_.at(current_char) == identifier || type_map_.at(current_char) == number_literal)
+
+		// the chunks only read the declarations parsed so far, through a scope that does not own the result
+		const shared_ptr<const xcl::document> scope(shared_ptr<const xcl::document>(), &result);
+		vector<optional<xcl::document>> parts(chunks.size());
+		vector<exception_ptr> errors(chunks.size());
+		parallel_for(chunks.size(), [&](const size_t index)
 		{
-			current_token.push_back(current_char);
-			column++;
-			return true;
-		}
-		if (is_keyword(current_token))
+			try
+			{
+				auto& part = parts[index].emplace(false);
+				part.import_document(scope);
+				source_token_stream tokens(source.substr(0, chunks[index].second), chunks[index].first);
+				parse_statements(part, tokens);
+			}
+			catch (...)
+			{
+				errors[index] = current_exception();
+			}
+		});
+
+		// the first error in source order is the one the sequential parser reports
+		for (size_t index = 0; index < chunks.size(); ++index)
 		{
-			current_type = keyword;
+			if (errors[index])
+			{
+				rethrow_exception(errors[index]);
+			}
+			result.adopt_data(move(*parts[index]));
 		}
-		tokens.emplace_back(current_type, line, column, current_token);
-		current_token.clear();
-		return false;
 	}
-	case operator_symbol:
+
+	if (!is_imported)
 	{
-		if (type_map_.at(current_char) == operator_symbol)
-		{
-			current_token.push_back(current_char);
-			column++;
-			return true;
-		}
-		tokens.emplace_back(operator_symbol, line, column, current_token);
-		current_token.clear();
-		return false;
-	}
-	case keyword:
-		break;
+		check_required_definitions(result);
 	}
-	return false;
+
+	return result;
 }
 
-void document_parser::initialize(const import_resolver_fn& import_resolver)
+xcl::document document_parser::parse_indexed(const std::string_view source, definition_index& index) const
 {
-	import_resolver_ = import_resolver;
-	keyword_handlers_["import"] = &document_parser::handle_import_keyword;
-	keyword_handlers_["section"] = &document_parser::handle_section_keyword;
-	keyword_handlers_["enum"] = &document_parser::handle_enum_keyword;
-	keyword_handlers_["list"] = &document_parser::handle_list_keyword;
-	keyword_handlers_["required"] = &document_parser::handle_required_keyword;
+	source_token_stream tokens(source);
+	auto result = parse(tokens, false);
+
+	index = {};
+	if (const auto runs = scan_statement_runs(source))
+	{
+		index.definitions = list_definitions(*runs, 0);
+		index.is_incremental = static_cast<size_t>(ranges::count(index.definitions, false, &definition_index::definition::is_declaration)) == result.get_data().size();
+	}
+	return result;
 }
 
-xcl::document document_parser::parse(const std::vector<token>& tokens, bool is_imported) const
+xcl::document document_parser::reparse(xcl::document&& previous, definition_index& index, const std::string_view source, const std::span<const text_edit> edits) const
 {
-	xcl::document result(is_imported);
+	if (edits.empty())
+	{
+		return std::move(previous);
+	}
 
-	auto token_iter = tokens.begin();
+	auto& definitions = index.definitions;
+	const auto edited_begin = ranges::min(edits, {}, &text_edit::offset).offset;
+	const auto edited_end = ranges::max(edits | views::transform([](const text_edit& edit) { return edit.offset + edit.removed; }));
+	ptrdiff_t delta = 0;
+	for (const auto& edit : edits)
+	{
+		delta += static_cast<ptrdiff_t>(edit.inserted) - static_cast<ptrdiff_t>(edit.removed);
+	}
 
-	while (token_iter != tokens.end()) {
-		switch (token_iter->get_type())
-		{
-		case keyword:
-			handle_keyword(result, tokens, token_iter);
-			break;
-		case identifier:
-			handle_identifier(result, tokens, token_iter);
-			break;
+	// definitions touching an edit are affected, an edit on a boundary may join or split the definitions on both sides
+	const auto first = ranges::find_if(definitions, [edited_begin](const auto& definition) { return definition.end >= edited_begin; });
+	const auto last = find_if(first, definitions.end(), [edited_end](const auto& definition) { return definition.begin > edited_end; });
+	const auto is_patchable = [&]
+	{
+		return index.is_incremental && first != last && none_of(first, last, [](const auto& definition) { return definition.is_declaration; });
+	};
+	if (!is_patchable())
+	{
+		return parse_indexed(source, index);
+	}
 
-		case whitespace:
-		case new_line:
-			++token_iter;
-			break;
+	const auto begin = first->begin;
+	const auto end = static_cast<size_t>(static_cast<ptrdiff_t>(prev(last)->end) + delta);
+	const auto runs = scan_statement_runs(source.substr(begin, end - begin));
+	if (!runs || ranges::any_of(*runs, &statement_run::is_declaration))
+	{
+		return parse_indexed(source, index);
+	}
 
-		case string_literal:
-		case number_literal:
-		case operator_symbol:
-			throw errors::unexpected_token_error(*token_iter);
-		}
+	// the edited definitions read the declarations through a scope that does not own the previous document
+	xcl::document part(false);
+	part.import_document(shared_ptr<const xcl::document>(shared_ptr<const xcl::document>(), &previous));
+	try
+	{
+		source_token_stream tokens(source.substr(0, end), begin);
+		parse_statements(part, tokens);
+	}
+	catch (const errors::xcl_exception&)
+	{
+		// the tokens after the region are needed to report the error the way the full parse does
+		return parse_indexed(source, index);
 	}
 
-	if (!is_imported)
+	auto replaced = list_definitions(*runs, begin);
+	const auto data_first = static_cast<size_t>(count_if(definitions.begin(), first, [](const auto& definition) { return !definition.is_declaration; }));
+	const auto data_count = static_cast<size_t>(distance(first, last));
+	const auto& data = previous.get_data();
+	const auto is_unique = part.get_data().size() == replaced.size() && ranges::all_of(part.get_data(), [&](const auto& entry)
 	{
-		const auto& data = result.get_data();
-		for (const auto& name : result.get_required_definitions() | views::keys)
-		{
-			if (!data.contains(name))
-			{
-				throw errors::xcl_runtime_error(std::format("The required value `{}` is not defined.", name));
-			}
-		}
+		const auto existing = static_cast<size_t>(data.find(entry.first) - data.begin());
+		return existing == data.size() || (existing >= data_first && existing < data_first + data_count);
+	});
+	// a required value removed by the edit is reported by the full parse, which leaves the previous document as it is
+	auto is_complete = true;
+	previous.for_each_required_definition([&](const xcl::symbol symbol, const types::type&)
+	{
+		const auto name = symbol_table::get_instance().get_name(symbol);
+		const auto existing = static_cast<size_t>(data.find(name) - data.begin());
+		is_complete &= part.get_data().contains(name) || (existing != data.size() && (existing < data_first || existing >= data_first + data_count));
+	});
+	if (!is_unique || !is_complete)
+	{
+		return parse_indexed(source, index);
 	}
 
-	return result;
+	previous.splice_data(data_first, data_count, std::move(part));
+
+	for (auto following = last; following != definitions.end(); ++following)
+	{
+		following->begin = static_cast<size_t>(static_cast<ptrdiff_t>(following->begin) + delta);
+		following->end = static_cast<size_t>(static_cast<ptrdiff_t>(following->end) + delta);
+	}
+	definitions.insert(definitions.erase(first, last), replaced.begin(), replaced.end());
+	return std::move(previous);
 }
 
-void document_parser::handle_keyword(xcl::document& document, const tokens_vector& tokens, std::vector<token>::const_iterator& token_iter) const
+void document_parser::parse_statements(xcl::document& document, token_stream& tokens, event_state* events) const
 {
-	if (keyword_handlers_.contains(token_iter->get_text()))
+	try
 	{
-		(this->*keyword_handlers_.at(token_iter->get_text()))(document, tokens, token_iter);
+		while (!tokens.at_end()) {
+			switch (tokens.current().get_type())
+			{
+			case keyword:
+				if (const auto type = handle_keyword(document, tokens); type != nullptr && events != nullptr)
+					events->handler.on_type_defined(*type);
+				break;
+			case identifier:
+				if (events != nullptr)
+					handle_identifier(document, tokens, *events);
+				else
+					handle_identifier(document, tokens);
+				break;
+
+			case new_line:
+				tokens.advance();
+				break;
+
+			case string_literal:
+			case number_literal:
+			case left_brace:
+			case right_brace:
+			case equals:
+			case comma:
+				throw errors::unexpected_token_error(tokens.current());
+			}
+		}
 	}
-	else
+	catch (errors::token_error& error)
 	{
-		throw errors::unexpected_token_error(*token_iter);
+		// line and column are only computed here, while the source of the token is still alive
+		if (!error.is_located())
+		{
+			if (const auto location = tokens.locate(error.get_position()))
+			{
+				error.set_location(*location);
+			}
+		}
+		throw;
 	}
 }
 
-void document_parser::handle_identifier(xcl::document& document, const tokens_vector& tokens, std::vector<token>::const_iterator& token_iter) const
+void document_parser::check_required_definitions(const xcl::document& document)
 {
-	// if identifier is name of a required value then expect its value, else identifier is a type name and there should be a value definition
-	expect_token_of_type(tokens, token_iter, identifier);
-	if (const auto required_data_type = document.resolve_required_definition(token_iter->get_text()); required_data_type != nullptr)
+	document.for_each_required_definition([&document](const xcl::symbol symbol, const types::type&)
 	{
-		handle_data_definition(document, tokens, token_iter, token_iter->get_text(), *required_data_type);
+		if (const auto name = symbol_table::get_instance().get_name(symbol); document.find_data(name) == nullptr)
+		{
+			throw errors::xcl_runtime_error(std::format("The required value `{}` is not defined.", name));
+		}
+	});
+}
+
+const xcl::types::type* document_parser::handle_keyword(xcl::document& document, token_stream& tokens) const
+{
+	switch (tokens.current().get_keyword())
+	{
+	case import_keyword:
+		handle_import_keyword(document, tokens);
+		return nullptr;
+	case section_keyword:
+		return &handle_section_keyword(document, tokens);
+	case enum_keyword:
+		return &handle_enum_keyword(document, tokens);
+	case list_keyword:
+		return &handle_list_keyword(document, tokens);
+	case required_keyword:
+		handle_required_keyword(document, tokens);
+		return nullptr;
+	default:
+		throw errors::unexpected_token_error(tokens.current());
 	}
-	else
+}
+
+void document_parser::handle_identifier(xcl::document& document, token_stream& tokens) const
+{
+	xcl::symbol symbol;
+	const auto& type = handle_definition_name(document, tokens, symbol);
+	handle_data_definition(document, tokens, symbol_table::get_instance().get_name(symbol), type);
+}
+
+void document_parser::handle_identifier(const xcl::document& document, token_stream& tokens, event_state& events) const
+{
+	xcl::symbol symbol;
+	const auto& type = handle_definition_name(document, tokens, symbol);
+	events.defined.insert(symbol);
+	handle_data_definition(tokens, symbol_table::get_instance().get_name(symbol), type, events);
+}
+
+const xcl::types::type& document_parser::handle_definition_name(const xcl::document& document, token_stream& tokens, xcl::symbol& name) const
+{
+	// syntax: <Identifier(Required Name)> | <Identifier(Type Name)> <Identifier>
+	// if the identifier is the name of a required value its value follows, else it is a type name followed by the name of the value
+
+	expect_token_of_type(tokens, identifier);
+	if (const auto required_data_type = document.resolve_required_definition(tokens.current().get_symbol()); required_data_type != nullptr)
 	{
-		// syntax: <Identifier(Type Name)> <Identifier> [ <Section Data> | <List Data> | = <Value>\n ]
+		name = tokens.current().get_symbol();
+		tokens.advance();
+		return *required_data_type;
+	}
 
-		const auto type = document.resolve_type_ptr(token_iter->get_text());
-		++token_iter;
+	const auto type = document.resolve_type_ptr(tokens.current().get_symbol());
+	tokens.advance();
 
-		expect_token_of_type(tokens, token_iter, identifier);
-		const auto& name = token_iter->get_text();
-		++token_iter;
+	expect_token_of_type(tokens, identifier);
+	name = tokens.current().get_symbol();
+	tokens.advance();
 
-		// validate that if the name is a required definition it's not using another type
-		if (const auto required_type = document.resolve_required_definition(name); required_type != nullptr)
+	// validate that if the name is a required definition it's not using another type
+	if (const auto required_type = document.resolve_required_definition(name); required_type != nullptr)
+	{
+		if (required_type != type)
 		{
-			if (required_type != type)
-			{
-				throw errors::type_mismatch_error(*type, *required_type);
-			}
+			throw errors::type_mismatch_error(*type, *required_type);
 		}
-
-		handle_data_definition(document, tokens, token_iter, name, *type);
 	}
+	return *type;
 }
 
-void document_parser::handle_data_definition(xcl::document& document, const tokens_vector& tokens, tokens_iter& token_iter, const std::string& name, const types::type& type) const
+void document_parser::handle_data_definition(xcl::document& document, token_stream& tokens, const std::string_view name, const types::type& type) const
 {
 	if (type_index(typeid(type)) == type_index(typeid(types::section)))
 	{
 		const auto& section_type = dynamic_cast<const types::section&>(type);
-		auto section = section_type.activate();
-		++token_iter;
+		const auto section = section_type.activate(document.get_arena());
 
-		handle_section_data(document, tokens, token_iter, section_type, *section);
+		handle_section_data(document, tokens, section_type, *section);
 
-		document.add_data(name, move(section));
+		document.add_data(name, xcl::value(*section));
 	}
 	else if (type_index(typeid(type)) == type_index(typeid(types::list)))
 	{
 		const auto& list_type = dynamic_cast<const types::list&>(type);
-		auto list = list_type.activate();
-		++token_iter;
+		const auto list = list_type.activate(document.get_arena());
 
-		handle_list_data(document, tokens, token_iter, list_type, *list);
+		handle_list_data(document, tokens, list_type, *list);
 
-		document.add_data(name, move(list));
+		document.add_data(name, xcl::value(*list));
 	}
 	else
 	{
-		expect_token_of_type(tokens, token_iter, operator_symbol);
-		if (token_iter->get_text() != "=")
-			throw errors::unexpected_token_error(*token_iter);
-		++token_iter;
+		expect_token_of_type(tokens, equals);
+		tokens.advance();
 
-		expect_token(tokens, token_iter);
-		auto value = type.activate(*token_iter);
-		++token_iter;
+		expect_token(tokens);
+		const auto value = type.activate(tokens.current(), document.get_arena());
+		tokens.advance();
 
-		expect_token_of_type(tokens, token_iter, new_line);
-		document.add_data(name, move(value));
+		expect_token_of_type(tokens, new_line);
+		document.add_data(name, value);
 	}
 }
 
-void document_parser::handle_section_data(xcl::document& document, const tokens_vector& tokens,
-	tokens_iter& token_iter, const types::section& section_type, objects::section& section_data) const
+void document_parser::handle_section_data(xcl::document& document, token_stream& tokens,
+	const types::section& section_type, objects::section& section_data) const
 {
 	// syntax: { <Identifier> = <Value>, <Identifier> = <Value>, ... }
 
-	expect_token_of_type(tokens, token_iter, operator_symbol);
-	if (token_iter->get_text() != "{")
-		throw errors::unexpected_token_error(*token_iter);
-	++token_iter;
+	expect_token_of_type(tokens, left_brace);
+	tokens.advance();
 
-	vector<string> fields;
-
-	while (token_iter->get_type() != operator_symbol || token_iter->get_text() != "}")
+	while (tokens.current().get_type() != right_brace)
 	{
-		handle_section_field_data(document, tokens, token_iter, section_type, section_data, fields);
+		handle_section_field_data(document, tokens, section_type, section_data);
 
-		expect_token_of_type(tokens, token_iter, operator_symbol);
-		if (token_iter->get_text() == ",")
+		expect_token_skip_new_line(tokens);
+		if (tokens.current().get_type() == comma)
 		{
-			++token_iter;
-			expect_token_skip_new_line(tokens, token_iter);
+			tokens.advance();
+			expect_token_skip_new_line(tokens);
 		}
-		else if (token_iter->get_text() == "}")
+		else if (tokens.current().get_type() == right_brace)
 		{
 			break;
 		}
 		else
 		{
-			throw errors::unexpected_token_error(*token_iter);
+			throw errors::unexpected_token_error(tokens.current());
 		}
 	}
-	++token_iter;
+	tokens.advance();
 
-	// validate that required fields are filled
-	for (const auto& field : section_type.get_fields())
-	{
-		if (!field->has_default_value() && ranges::count(fields.begin(), fields.end(), field->get_name()) != 1)
-		{
-			throw errors::required_field_not_set_error(field->get_name(), section_type.get_name());
-		}
-	}
+	section_type.check_required_fields(section_data);
 }
 
-void document_parser::handle_section_field_data(xcl::document& document, const tokens_vector& tokens,
-	tokens_iter& token_iter, const types::section& type, objects::section& data, std::vector<std::string>& fields) const
+void document_parser::handle_section_field_data(xcl::document& document, token_stream& tokens,
+	const types::section& type, objects::section& data) const
 {
 	// syntax: <Identifier> = <Value>
 
-	expect_token_of_type(tokens, token_iter, identifier);
-	const auto& field = type.resolve_field(token_iter->get_text());
-	const auto& field_type = field.get_type();
-	++token_iter;
+	expect_token_of_type(tokens, identifier);
+	const auto slot = type.resolve_slot(tokens.current().get_text());
+	const auto& field_type = type.get_fields()[slot]->get_type();
+	tokens.advance();
 
-	expect_token_of_type(tokens, token_iter, operator_symbol);
-	if (token_iter->get_text() != "=")
-		throw errors::unexpected_end_of_tokens_error(*token_iter);
-	++token_iter;
+	expect_token_of_type(tokens, equals);
+	tokens.advance();
 
-	expect_token(tokens, token_iter);
+	expect_token(tokens);
 	// TODO: handle nested section
-	auto value = field_type.activate(*token_iter);
-	++token_iter;
+	const auto value = field_type.activate(tokens.current(), document.get_arena());
+	tokens.advance();
 
-	data.set_value(field.get_name(), move(value));
-	fields.push_back(field.get_name());
+	data.set_value(slot, value);
 }
 
-void document_parser::handle_section_field(const xcl::document& document, const tokens_vector& tokens,
-	tokens_iter& token_iter, types::section& section_type) const
+void document_parser::handle_section_field(const xcl::document& document, token_stream& tokens,
+	types::section& section_type) const
 {
 	// syntax: <Identifier(Type Name)> <Identifier> [<Keyword(default)> <Value> | <Keyword(required)>],
 
-	expect_token_of_type(tokens, token_iter, identifier);
-	const auto& type = document.resolve_type(token_iter->get_text());
+	expect_token_of_type(tokens, identifier);
+	const auto& type = document.resolve_type(tokens.current().get_symbol());
 	// TODO: handle nested sections
 	if (type_index(typeid(type)) == type_index(typeid(types::section)))
 		throw errors::type_not_found_error(type.get_name());
-	++token_iter;
+	tokens.advance();
 
-	expect_token_of_type(tokens, token_iter, identifier);
-	const auto& name = token_iter->get_text();
-	++token_iter;
+	expect_token_of_type(tokens, identifier);
+	const string name(tokens.current().get_text());
+	tokens.advance();
 
-	expect_token_of_type(tokens, token_iter, keyword);
-	if (token_iter->get_text() == "default")
+	expect_token_of_type(tokens, keyword);
+	if (tokens.current().get_keyword() == default_keyword)
 	{
-		++token_iter;
+		tokens.advance();
 
-		expect_token(tokens, token_iter);
-		auto default_value = type.activate(*token_iter);
-		++token_iter;
+		expect_token(tokens);
+		const auto default_value = type.activate(tokens.current(), document.get_arena());
+		tokens.advance();
 
-		expect_token_of_type(tokens, token_iter, operator_symbol);
-		if (token_iter->get_text() != ",")
-		{
-			throw errors::unexpected_token_error(*token_iter);
-		}
-		++token_iter;
+		expect_token_of_type(tokens, comma);
+		tokens.advance();
 
-		section_type.add_field(name, type, move(default_value));
+		section_type.add_field(name, type, default_value);
 	}
-	else if (token_iter->get_text() == "required")
+	else if (tokens.current().get_keyword() == required_keyword)
 	{
-		++token_iter;
+		tokens.advance();
 
-		expect_token_of_type(tokens, token_iter, operator_symbol);
-		if (token_iter->get_text() != ",")
-		{
-			throw errors::unexpected_token_error(*token_iter);
-		}
-		++token_iter;
+		expect_token_of_type(tokens, comma);
+		tokens.advance();
 
-		section_type.add_field(name, type, unique_ptr<objects::object>(nullptr));
+		section_type.add_field(name, type, xcl::value());
 	}
 	else
 	{
-		throw errors::unexpected_token_error(*token_iter);
+		throw errors::unexpected_token_error(tokens.current());
 	}
 }
 
-void document_parser::handle_list_data(xcl::document& document, const tokens_vector& tokens, tokens_iter& tokens_iter,
+void document_parser::handle_list_data(xcl::document& document, token_stream& tokens,
 	const types::list& list_type, objects::list& list_data) const
 {
 	// syntax: { <Value>, <Value>, ... }
 
-	expect_token_of_type(tokens, tokens_iter, operator_symbol);
-	if (tokens_iter->get_text() != "{")
-		throw errors::unexpected_token_error(*tokens_iter);
-	++tokens_iter;
+	expect_token_of_type(tokens, left_brace);
+	tokens.advance();
 
-	while (tokens_iter->get_type() != operator_symbol || tokens_iter->get_text() != "}")
+	while (tokens.current().get_type() != right_brace)
 	{
-		expect_token_skip_new_line(tokens, tokens_iter);
+		expect_token_skip_new_line(tokens);
 
 		// TODO: handle list of lists and sections
-		auto value = list_type.get_contained_type().activate(*tokens_iter);
-		++tokens_iter;
+		const auto value = list_type.get_contained_type().activate(tokens.current(), document.get_arena());
+		tokens.advance();
+
+		list_data.add_value(value);
+
+		expect_token_skip_new_line(tokens);
+		if (tokens.current().get_type() == comma)
+		{
+			tokens.advance();
+			expect_token_skip_new_line(tokens);
+		}
+		else if (tokens.current().get_type() == right_brace)
+		{
+			break;
+		}
+		else
+		{
+			throw errors::unexpected_token_error(tokens.current());
+		}
+	}
+	tokens.advance();
+}
+
+void document_parser::handle_data_definition(token_stream& tokens, const std::string_view name, const types::type& type, event_state& events) const
+{
+	events.handler.on_definition_begin(name, type);
+	if (type_index(typeid(type)) == type_index(typeid(types::section)))
+	{
+		handle_section_data(tokens, dynamic_cast<const types::section&>(type), events);
+	}
+	else if (type_index(typeid(type)) == type_index(typeid(types::list)))
+	{
+		handle_list_data(tokens, dynamic_cast<const types::list&>(type), events);
+	}
+	else
+	{
+		expect_token_of_type(tokens, equals);
+		tokens.advance();
+
+		expect_token(tokens);
+		// the value may view the text of the token, which a stream that reads ahead can drop once it advances
+		events.handler.on_value(activate_view(type, tokens.current(), events.scratch));
+		events.scratch.release();
+		tokens.advance();
+
+		expect_token_of_type(tokens, new_line);
+	}
+	events.handler.on_definition_end(name, type);
+}
+
+void document_parser::handle_section_data(token_stream& tokens, const types::section& section_type, event_state& events) const
+{
+	// syntax: { <Identifier> = <Value>, <Identifier> = <Value>, ... }
+
+	events.set_fields.assign((section_type.get_fields().size() + 63) / 64, 0);
+
+	expect_token_of_type(tokens, left_brace);
+	tokens.advance();
+
+	while (tokens.current().get_type() != right_brace)
+	{
+		expect_token_of_type(tokens, identifier);
+		const auto slot = section_type.resolve_slot(tokens.current().get_text());
+		const auto& field = *section_type.get_fields()[slot];
+		tokens.advance();
+
+		expect_token_of_type(tokens, equals);
+		tokens.advance();
+
+		expect_token(tokens);
+		events.handler.on_field(field.get_name(), activate_view(field.get_type(), tokens.current(), events.scratch));
+		events.scratch.release();
+		events.set_fields[slot / 64] |= uint64_t{1} << slot % 64;
+		tokens.advance();
+
+		expect_token_skip_new_line(tokens);
+		if (tokens.current().get_type() == comma)
+		{
+			tokens.advance();
+			expect_token_skip_new_line(tokens);
+		}
+		else if (tokens.current().get_type() == right_brace)
+		{
+			break;
+		}
+		else
+		{
+			throw errors::unexpected_token_error(tokens.current());
+		}
+	}
+	tokens.advance();
+
+	section_type.check_required_fields(events.set_fields);
+}
 
-		list_data.add_value(std::move(value));
+void document_parser::handle_list_data(token_stream& tokens, const types::list& list_type, event_state& events) const
+{
+	// syntax: { <Value>, <Value>, ... }
 
-		expect_token_of_type(tokens, tokens_iter, operator_symbol);
-		if (tokens_iter->get_text() == ",")
+	expect_token_of_type(tokens, left_brace);
+	tokens.advance();
+
+	while (tokens.current().get_type() != right_brace)
+	{
+		expect_token_skip_new_line(tokens);
+
+		events.handler.on_list_value(activate_view(list_type.get_contained_type(), tokens.current(), events.scratch));
+		events.scratch.release();
+		tokens.advance();
+
+		expect_token_skip_new_line(tokens);
+		if (tokens.current().get_type() == comma)
 		{
-			++tokens_iter;
-			expect_token_skip_new_line(tokens, tokens_iter);
+			tokens.advance();
+			expect_token_skip_new_line(tokens);
 		}
-		else if (tokens_iter->get_text() == "}")
+		else if (tokens.current().get_type() == right_brace)
 		{
 			break;
 		}
 		else
 		{
-			throw errors::unexpected_token_error(*tokens_iter);
+			throw errors::unexpected_token_error(tokens.current());
 		}
 	}
-	++tokens_iter;
+	tokens.advance();
+}
+
+xcl::value document_parser::activate_view(const types::type& type, const token& token, std::pmr::memory_resource& scratch)
+{
+	// a string refers to the source, the other scalars are held by the value, only a field of a container type allocates
+	if (type_index(typeid(type)) == type_index(typeid(types::string)))
+	{
+		if (token.get_type() != string_literal)
+			throw errors::unexpected_token_error(token);
+		const auto text = token.get_text();
+		return { dynamic_cast<const types::string&>(type), text.substr(1, text.size() - 2) };
+	}
+	return type.activate(token, scratch);
 }
 
-void document_parser::handle_import_keyword(xcl::document& document, const tokens_vector& tokens, std::vector<token>::const_iterator& tokens_iter) const
+void document_parser::handle_import_keyword(xcl::document& document, token_stream& tokens) const
 {
 	// syntax: import <String Literal>\n
 
-	++tokens_iter;
+	tokens.advance();
 
-	expect_token_of_type(tokens, tokens_iter, string_literal);
-	document.import_document(import_resolver_(tokens_iter->parse_string_literal()));
-	++tokens_iter;
+	expect_token_of_type(tokens, string_literal);
+	const auto name = tokens.current().parse_string_literal();
+	try
+	{
+		document.import_document(import_resolver_ != nullptr ? import_resolver_(name) : parse_import(name));
+	}
+	catch (errors::import_cycle_error& error)
+	{
+		// the innermost import is the one closing the cycle
+		if (!error.is_located())
+		{
+			if (const auto location = tokens.locate(tokens.current().get_text().data()))
+			{
+				error.set_location(*location);
+			}
+		}
+		throw;
+	}
+	tokens.advance();
 
-	expect_token_of_type(tokens, tokens_iter, new_line);
-	++tokens_iter;
+	expect_token_of_type(tokens, new_line);
+	tokens.advance();
 }
 
-void document_parser::handle_section_keyword(xcl::document& document, const tokens_vector& tokens, std::vector<token>::const_iterator& token_iter) const
+const xcl::types::type& document_parser::handle_section_keyword(xcl::document& document, token_stream& tokens) const
 {
 	// syntax: section <Identifier> { <Fields> }
-	++token_iter;
+	tokens.advance();
 
-	expect_token_of_type(tokens, token_iter, identifier);
-	auto section_definition = make_unique<types::section>(token_iter->get_text());
-	++token_iter;
+	expect_token_of_type(tokens, identifier);
+	auto section_definition = make_unique<types::section>(string(tokens.current().get_text()));
+	tokens.advance();
 
-	expect_token_of_type(tokens, token_iter, operator_symbol);
-	if (token_iter->get_text() != "{")
-		throw errors::unexpected_token_error(*token_iter);
-	++token_iter;
+	expect_token_of_type(tokens, left_brace);
+	tokens.advance();
 
-	while (token_iter->get_type() != operator_symbol || token_iter->get_text() != "}")
+	while (tokens.current().get_type() != right_brace)
 	{
-		handle_section_field(document, tokens, token_iter, *section_definition);
-		expect_token_skip_new_line(tokens, token_iter);
+		handle_section_field(document, tokens, *section_definition);
+		expect_token_skip_new_line(tokens);
 	}
-	++token_iter;
+	tokens.advance();
 
+	const auto& result = *section_definition;
 	document.register_type(move(section_definition));
+	return result;
 }
 
-void document_parser::handle_enum_keyword(xcl::document& document, const tokens_vector& tokens, std::vector<token>::const_iterator& token_iter) const
+const xcl::types::type& document_parser::handle_enum_keyword(xcl::document& document, token_stream& tokens) const
 {
 	// syntax: enum <Identifier> { <Identifier>, <Identifier>, ... }
 
-	++token_iter;
+	tokens.advance();
 
-	expect_token_of_type(tokens, token_iter, identifier);
-	auto enum_definition = make_unique<types::enumeration>(token_iter->get_text());
-	++token_iter;
+	expect_token_of_type(tokens, identifier);
+	auto enum_definition = make_unique<types::enumeration>(string(tokens.current().get_text()));
+	tokens.advance();
 
-	expect_token_of_type(tokens, token_iter, operator_symbol);
-	if (token_iter->get_text() != "{")
-	{
-		throw errors::unexpected_token_error(*token_iter);
-	}
-	++token_iter;
+	expect_token_of_type(tokens, left_brace);
+	tokens.advance();
 
-	while (token_iter->get_type() != operator_symbol || token_iter->get_text() != "}")
+	while (tokens.current().get_type() != right_brace)
 	{
-		expect_token_of_type(tokens, token_iter, identifier);
-		enum_definition->add_value(token_iter->get_text());
-		++token_iter;
+		expect_token_of_type(tokens, identifier);
+		enum_definition->add_value(string(tokens.current().get_text()));
+		tokens.advance();
 
-		expect_token_of_type(tokens, token_iter, operator_symbol);
-		if (token_iter->get_text() == ",")
+		expect_token_skip_new_line(tokens);
+		if (tokens.current().get_type() == comma)
 		{
-			++token_iter;
+			tokens.advance();
 
-			expect_token_skip_new_line(tokens, token_iter);
+			expect_token_skip_new_line(tokens);
+		}
+		else if (tokens.current().get_type() != right_brace)
+		{
+			throw errors::unexpected_token_error(tokens.current());
 		}
 	}
-	++token_iter;
+	tokens.advance();
 
+	const auto& result = *enum_definition;
 	document.register_type(move(enum_definition));
+	return result;
 }
 
-void document_parser::handle_list_keyword(xcl::document& document, const tokens_vector& tokens, std::vector<token>::const_iterator& token_iter) const
+const xcl::types::type& document_parser::handle_list_keyword(xcl::document& document, token_stream& tokens) const
 {
 	// syntax: list <Identifier(Type Name)> { <Identifier(Type Name)> }
 
-	++token_iter;
+	tokens.advance();
 
-	expect_token_of_type(tokens, token_iter, identifier);
-	const auto& name = token_iter->get_text();
-	++token_iter;
+	expect_token_of_type(tokens, identifier);
+	const string name(tokens.current().get_text());
+	tokens.advance();
 
-	expect_token_of_type(tokens, token_iter, operator_symbol);
-	if (token_iter->get_text() != "{")
-		throw errors::unexpected_token_error(*token_iter);
-	++token_iter;
+	expect_token_of_type(tokens, left_brace);
+	tokens.advance();
 
-	expect_token_of_type(tokens, token_iter, identifier);
-	const auto& type = document.resolve_type(token_iter->get_text());
-	++token_iter;
+	expect_token_of_type(tokens, identifier);
+	const auto& type = document.resolve_type(tokens.current().get_symbol());
+	tokens.advance();
 
-	expect_token_of_type(tokens, token_iter, operator_symbol);
-	if (token_iter->get_text() != "}")
-		throw errors::unexpected_token_error(*token_iter);
-	++token_iter;
+	expect_token_of_type(tokens, right_brace);
+	tokens.advance();
 
 	auto list_type = make_shared<types::list>(name, type);
+	const auto& result = *list_type;
 	document.register_type(std::move(list_type));
+	return result;
 }
 
-void document_parser::handle_required_keyword(xcl::document& document, const tokens_vector& tokens, std::vector<token>::const_iterator& token_iter) const
+void document_parser::handle_required_keyword(xcl::document& document, token_stream& tokens) const
 {
 	// syntax: required <Identifier(Type Name)> <Identifier>\n
 
-	++token_iter;
+	tokens.advance();
 
-	expect_token_of_type(tokens, token_iter, identifier);
-	const auto& type = document.resolve_type_ptr(token_iter->get_text());
-	++token_iter;
+	expect_token_of_type(tokens, identifier);
+	const auto& type = document.resolve_type_ptr(tokens.current().get_symbol());
+	tokens.advance();
 
-	expect_token_of_type(tokens, token_iter, identifier);
-	document.add_required_definition(token_iter->get_text(), type);
-	++token_iter;
+	expect_token_of_type(tokens, identifier);
+	document.add_required_definition(tokens.current().get_symbol(), type);
+	tokens.advance();
 
-	expect_token_of_type(tokens, token_iter, new_line);
-	++token_iter;
+	expect_token_of_type(tokens, new_line);
+	tokens.advance();
 }
@@ -1,67 +1,136 @@
 ﻿#pragma once
 
+#include <filesystem>
 #include <functional>
 #include <iostream>
+#include <memory_resource>
+#include <span>
+#include <string_view>
+#include <unordered_set>
 #include <vector>
-#include <unordered_map>
 
 #include "document.h"
+#include "event_handler.h"
+#include "import_cache.h"
 #include "list.h"
 #include "section.h"
+#include "statement_scanner.h"
 #include "token.h"
+#include "token_stream.h"
 
 namespace xcl::parser
 {
 	class document_parser;
 
-	typedef std::vector<token> tokens_vector;
-	typedef std::vector<token>::const_iterator tokens_iter;
-	
-	typedef std::function<xcl::document(const std::string&)> import_resolver_fn;
-	typedef void(document_parser::*keyword_handler)(xcl::document&, const tokens_vector& tokens, tokens_iter&) const;
+	typedef std::function<std::shared_ptr<const xcl::document>(const std::string&)> import_resolver_fn;
 
 	class tokenizer
 	{
 	public:
-		void initialize();
-
 		[[nodiscard]] tokens_vector tokenize(std::istream& input) const;
 
-	private:
-		void update_current_type(const char& current_char, token_type& current_type) const;
-		bool process_current_char(std::vector<token>& tokens, token_type current_type, const char& current_char, std::string& current_token, int& line, int& column) const;
-
-		std::map<char, token_type> type_map_;
+		// the returned tokens refer to the input, which must outlive them
+		[[nodiscard]] tokens_vector tokenize(std::string_view input) const;
 	};
 
 	class document_parser
 	{
 	public:
+		// files from this size on are parsed with parse_parallel
+		static constexpr size_t parallel_file_size = 16 * 1024 * 1024;
+		// data definitions are parsed in parallel in chunks of at least this size
+		static constexpr size_t parallel_chunk_size = 64 * 1024;
+
 		void initialize(const import_resolver_fn& import_resolver);
 		
 		[[nodiscard]] xcl::document parse(const tokens_vector& tokens, bool is_imported) const;
 
+		// tokens are read from the input in chunks while parsing, so the whole input is never held in memory
+		[[nodiscard]] xcl::document parse(std::istream& input, bool is_imported) const;
+
+		// reading, lexing and parsing run on separate threads and overlap, for large inputs from slow storage
+		[[nodiscard]] xcl::document parse_pipelined(std::istream& input, bool is_imported) const;
+
+		[[nodiscard]] xcl::document parse(token_stream& tokens, bool is_imported) const;
+
+		// declarations are parsed in order, the data definitions between them are split in chunks that are parsed in parallel
+		// and appended in their order
+		[[nodiscard]] xcl::document parse_parallel(std::string_view source, bool is_imported) const;
+
+		// records the top-level definitions of the source in the index, so that edits of it can be reparsed
+		[[nodiscard]] xcl::document parse_indexed(std::string_view source, definition_index& index) const;
+
+		// source is the text after the edits, only the data definitions touched by them are parsed and patched into the previous document,
+		// an edit of a declaration or one that changes the structure beyond the touched definitions parses the whole source again
+		// the previous document is unchanged when the edited source has an error
+		[[nodiscard]] xcl::document reparse(xcl::document&& previous, definition_index& index, std::string_view source, std::span<const text_edit> edits) const;
+
+		// tokenizes the file directly from a read-only mapping of it
+		// without an import resolver, imports are mapped the same way relative to the importing file and kept in the import cache,
+		// all files reachable through imports are parsed up front, the files that do not depend on each other in parallel,
+		// a large file is parsed in parallel as well
+		[[nodiscard]] xcl::document parse_file(const std::filesystem::path& path, bool is_imported = false) const;
+
+		// reports the content of the source to the handler instead of building a document, only the declarations are kept while parsing
+		// the required definitions are checked at the end
+		void parse(token_stream& tokens, event_handler& handler) const;
+
+		// maps the file and reports its content to the handler, imports are resolved the same way as by parse_file
+		void parse_file(const std::filesystem::path& path, event_handler& handler) const;
+
+		// the cache can be shared by several parsers, its counters are meant for monitoring
+		void set_import_cache(std::shared_ptr<xcl::import_cache> import_cache) { import_cache_ = std::move(import_cache); }
+		[[nodiscard]] xcl::import_cache& get_import_cache() const noexcept { return *import_cache_; }
+
 	private:
-		void handle_keyword(xcl::document& document, const tokens_vector& tokens, tokens_iter& token_iter) const;
-		void handle_identifier(xcl::document& document, const tokens_vector& tokens, tokens_iter& token_iter) const;
-		void handle_data_definition(xcl::document& document, const tokens_vector& tokens, tokens_iter& token_iter, const std::string& name, const types::type& type) const;
-		void handle_section_data(xcl::document& document, const tokens_vector& tokens, tokens_iter& token_iter, const types::section& section_type, objects::section& section_data) const;
-		void handle_section_field_data(xcl::document& document, const tokens_vector& tokens, tokens_iter& token_iter, const types::section& type, objects::section& data, std::vector<std::string>& fields) const;
-		void handle_section_field(const xcl::document& document, const tokens_vector& tokens, tokens_iter& token_iter, types::section& section_type) const;
-		void handle_list_data(xcl::document& document, const tokens_vector& tokens, tokens_iter& tokens_iter, const types::list& list_type, objects::list& list_data) const;
-
-		void handle_import_keyword(xcl::document& document, const tokens_vector& tokens, tokens_iter& token_iter) const;
-		void handle_section_keyword(xcl::document& document, const tokens_vector& tokens, tokens_iter& token_iter) const;
-		void handle_enum_keyword(xcl::document& document, const tokens_vector& tokens, tokens_iter& token_iter) const;
-		void handle_list_keyword(xcl::document& document, const tokens_vector& tokens, tokens_iter& token_iter) const;
-		void handle_required_keyword(xcl::document& document, const tokens_vector& tokens, tokens_iter& token_iter) const;
-
-		static void expect_token(const tokens_vector& tokens, tokens_iter& token_iter);
-		static void expect_token_skip_new_line(const tokens_vector& tokens, tokens_iter& token_iter);
-		static void expect_token_of_type(const tokens_vector& tokens, tokens_iter& token_iter, const token_type expected_type);
+		// without an import resolver, resolves the imports of the file relative to it
+		[[nodiscard]] document_parser make_file_parser(const std::filesystem::path& path) const;
+		[[nodiscard]] std::shared_ptr<const xcl::document> parse_import(const std::filesystem::path& path) const;
+		void preload_imports(const std::filesystem::path& path) const;
 
-		import_resolver_fn import_resolver_{nullptr};
+		// the state of an event parse, the definitions are reported instead of being added to the document
+		struct event_state
+		{
+			event_handler& handler;
+			// the names defined so far, only for the check of the required values
+			std::unordered_set<xcl::symbol> defined;
+			// the fields set in the current section, reused by every section
+			std::vector<uint64_t> set_fields;
+			// holds the objects of a value of a container type, released once the value is reported
+			std::pmr::monotonic_buffer_resource scratch;
+		};
+
+		void parse_statements(xcl::document& document, token_stream& tokens, event_state* events = nullptr) const;
+		static void check_required_definitions(const xcl::document& document);
 
-		std::unordered_map<std::string_view, keyword_handler> keyword_handlers_;
+		// returns the type a declaration defined, null for other keywords
+		const types::type* handle_keyword(xcl::document& document, token_stream& tokens) const;
+		void handle_identifier(xcl::document& document, token_stream& tokens) const;
+		void handle_identifier(const xcl::document& document, token_stream& tokens, event_state& events) const;
+		[[nodiscard]] const types::type& handle_definition_name(const xcl::document& document, token_stream& tokens, xcl::symbol& name) const;
+		void handle_data_definition(xcl::document& document, token_stream& tokens, std::string_view name, const types::type& type) const;
+		void handle_section_data(xcl::document& document, token_stream& tokens, const types::section& section_type, objects::section& section_data) const;
+		void handle_section_field_data(xcl::document& document, token_stream& tokens, const types::section& type, objects::section& data) const;
+		void handle_section_field(const xcl::document& document, token_stream& tokens, types::section& section_type) const;
+		void handle_list_data(xcl::document& document, token_stream& tokens, const types::list& list_type, objects::list& list_data) const;
+
+		void handle_data_definition(token_stream& tokens, std::string_view name, const types::type& type, event_state& events) const;
+		void handle_section_data(token_stream& tokens, const types::section& section_type, event_state& events) const;
+		void handle_list_data(token_stream& tokens, const types::list& list_type, event_state& events) const;
+		// a string value refers to the text of the token instead of a copy of it
+		[[nodiscard]] static xcl::value activate_view(const types::type& type, const token& token, std::pmr::memory_resource& scratch);
+
+		void handle_import_keyword(xcl::document& document, token_stream& tokens) const;
+		const types::type& handle_section_keyword(xcl::document& document, token_stream& tokens) const;
+		const types::type& handle_enum_keyword(xcl::document& document, token_stream& tokens) const;
+		const types::type& handle_list_keyword(xcl::document& document, token_stream& tokens) const;
+		void handle_required_keyword(xcl::document& document, token_stream& tokens) const;
+
+		static void expect_token(token_stream& tokens);
+		static void expect_token_skip_new_line(token_stream& tokens);
+		static void expect_token_of_type(token_stream& tokens, const token_type expected_type);
+
+		import_resolver_fn import_resolver_{nullptr};
+		std::shared_ptr<xcl::import_cache> import_cache_{std::make_shared<xcl::import_cache>()};
 	};
 }
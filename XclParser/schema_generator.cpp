@@ -0,0 +1,629 @@
+﻿#include "pch.h"
+#include "schema_generator.h"
+
+#include <bit>
+#include <cctype>
+#include <format>
+#include <iterator>
+#include <map>
+#include <ranges>
+#include <unordered_set>
+
+#include "boolean.h"
+#include "enumeration.h"
+#include "exception.h"
+#include "generated_parser.h"
+#include "list.h"
+#include "number.h"
+#include "section.h"
+#include "symbol_table.h"
+#include "xcl_string.h"
+
+using namespace std;
+
+namespace
+{
+	constexpr std::string_view cpp_keywords[] = {
+		"alignas", "alignof", "and", "asm", "auto", "bool", "break", "case", "catch", "char", "class", "const", "constexpr", "continue",
+		"default", "delete", "do", "double", "else", "enum", "explicit", "export", "extern", "false", "float", "for", "friend", "goto",
+		"if", "inline", "int", "long", "mutable", "namespace", "new", "noexcept", "not", "nullptr", "operator", "or", "private",
+		"protected", "public", "register", "return", "short", "signed", "sizeof", "static", "struct", "switch", "template", "this",
+		"throw", "true", "try", "typedef", "typename", "union", "unsigned", "using", "virtual", "void", "volatile", "while", "xor",
+	};
+
+	// MyTestConfig becomes my_test_config, a name that is a keyword gets a trailing underscore
+	std::string to_snake_case(const std::string_view name)
+	{
+		string result;
+		for (size_t index = 0; index < name.size(); ++index)
+		{
+			const auto character = static_cast<unsigned char>(name[index]);
+			if (isupper(character) && index > 0 && !result.ends_with('_'))
+			{
+				const auto previous = static_cast<unsigned char>(name[index - 1]);
+				const auto next = index + 1 < name.size() ? static_cast<unsigned char>(name[index + 1]) : '\0';
+				if (islower(previous) || isdigit(previous) || (isupper(previous) && islower(next)))
+					result += '_';
+			}
+			result += static_cast<char>(tolower(character));
+		}
+		if (ranges::find(cpp_keywords, result) != end(cpp_keywords))
+			result += '_';
+		return result;
+	}
+
+	std::string quote(const std::string_view text)
+	{
+		string result = "\"";
+		for (const auto character : text)
+		{
+			switch (character)
+			{
+			case '"': result += "\\\""; break;
+			case '\\': result += "\\\\"; break;
+			case '\n': result += "\\n"; break;
+			case '\r': result += "\\r"; break;
+			case '\t': result += "\\t"; break;
+			default: result += character; break;
+			}
+		}
+		result += '"';
+		return result;
+	}
+
+	// the seed and size of a table in which every name has a slot of its own, the names must be distinct
+	std::pair<uint64_t, size_t> find_perfect_hash(const std::vector<std::string>& names, const std::string_view type_name)
+	{
+		// distinct names fit a table of a few times their count, a larger one is not worth generating
+		const auto min_size = std::bit_ceil(std::max<size_t>(names.size(), 1));
+		for (auto size = min_size; size <= min_size * 64; size *= 2)
+		{
+			for (uint64_t attempt = 0; attempt < 4096; ++attempt)
+			{
+				const auto seed = xcl::generated::hash_name({}) ^ attempt;
+				vector<bool> is_taken(size);
+				auto is_perfect = true;
+				for (const auto& name : names)
+				{
+					const auto slot = xcl::generated::hash_name(name, seed) & (size - 1);
+					if (is_taken[slot])
+					{
+						is_perfect = false;
+						break;
+					}
+					is_taken[slot] = true;
+				}
+				if (is_perfect)
+					return { seed, size };
+			}
+		}
+		throw xcl::errors::xcl_runtime_error(std::format("The values of `{}` have no table in which each has a slot of its own.", type_name));
+	}
+
+	class parser_generator
+	{
+	public:
+		parser_generator(const xcl::document& schema, const std::string_view namespace_name, const std::string_view document_name) :
+			namespace_name_(namespace_name),
+			document_name_(document_name)
+		{
+			collect_types(schema);
+			ranges::sort(enumerations_, {}, &xcl::types::type::get_name);
+			ranges::sort(sections_, {}, &xcl::types::type::get_name);
+			ranges::sort(lists_, {}, &xcl::types::type::get_name);
+
+			// the first definition of a name wins, as in the document
+			schema.for_each_required_definition([this](const xcl::symbol name, const xcl::types::type& type)
+			{
+				requireds_.try_emplace(string(xcl::symbol_table::get_instance().get_name(name)), &type);
+			});
+
+			check_names();
+		}
+
+		std::string generate()
+		{
+			write_line(0, "// generated by xcl::generate_parser, changes are lost when the schema is generated again");
+			write_line(0, "#pragma once");
+			write_line(0, "");
+			write_line(0, "#include <algorithm>");
+			write_line(0, "#include <array>");
+			write_line(0, "#include <iterator>");
+			write_line(0, "#include <string>");
+			write_line(0, "#include <string_view>");
+			write_line(0, "#include <tuple>");
+			write_line(0, "#include <utility>");
+			write_line(0, "#include <vector>");
+			write_line(0, "");
+			write_line(0, "#include \"binding.h\"");
+			write_line(0, "#include \"generated_parser.h\"");
+			write_line(0, "");
+			write_line(0, std::format("namespace {}", namespace_name_));
+			write_line(0, "{");
+
+			for (const auto enumeration : enumerations_)
+				write_enumeration_type(*enumeration);
+			for (const auto list : lists_)
+				write_line(1, std::format("typedef std::vector<{}> {};\n", get_cpp_type(list->get_contained_type()), to_snake_case(list->get_name())));
+			for (const auto section : sections_)
+				write_section_type(*section);
+			write_document_type();
+
+			for (const auto enumeration : enumerations_)
+				write_enumeration_parser(*enumeration);
+			for (const auto list : lists_)
+				write_list_parser(*list);
+			for (const auto section : sections_)
+				write_section_parser(*section);
+			write_definition_skipper();
+			write_document_parser();
+
+			code_.pop_back();
+			write_line(0, "}");
+			write_line(0, "");
+
+			for (const auto enumeration : enumerations_)
+				write_enumeration_schema(*enumeration);
+			for (const auto section : sections_)
+				write_section_schema(*section);
+
+			code_.pop_back();
+			return std::move(code_);
+		}
+
+	private:
+		void collect_types(const xcl::document& document)
+		{
+			for (const auto& type : document.get_types() | views::values)
+			{
+				if (!collected_.insert(type.get()).second)
+					continue;
+				if (const auto enumeration = dynamic_cast<const xcl::types::enumeration*>(type.get()))
+					enumerations_.push_back(enumeration);
+				else if (const auto section = dynamic_cast<const xcl::types::section*>(type.get()))
+					sections_.push_back(section);
+				else if (const auto list = dynamic_cast<const xcl::types::list*>(type.get()))
+					lists_.push_back(list);
+			}
+			for (const auto& import : document.get_imports())
+				collect_types(*import);
+		}
+
+		// the C++ names must stay apart after their conversion
+		void check_names() const
+		{
+			const auto check_unique = [](const auto& names, const std::string_view scope)
+			{
+				map<string, string> converted;
+				for (const auto& name : names)
+				{
+					if (const auto [entry, is_new] = converted.try_emplace(to_snake_case(name), name); !is_new && entry->second != name)
+					{
+						throw xcl::errors::xcl_runtime_error(std::format("The names `{}` and `{}` of {} both become `{}` in C++.", entry->second, name, scope, entry->first));
+					}
+				}
+			};
+
+			vector<string> type_names;
+			for (const auto enumeration : enumerations_)
+			{
+				type_names.push_back(enumeration->get_name());
+				if (unordered_set<string_view> values; !ranges::all_of(enumeration->get_values(), [&values](const string& value) { return values.insert(value).second; }))
+				{
+					throw xcl::errors::xcl_runtime_error(std::format("`{}` declares a value more than once.", enumeration->get_name()));
+				}
+				check_unique(enumeration->get_values(), std::format("`{}`", enumeration->get_name()));
+			}
+			for (const auto list : lists_)
+				type_names.push_back(list->get_name());
+			for (const auto section : sections_)
+			{
+				type_names.push_back(section->get_name());
+				vector<string> field_names;
+				for (const auto& field : section->get_fields())
+				{
+					field_names.push_back(field->get_name());
+					(void)get_cpp_type(field->get_type());
+					if (dynamic_cast<const xcl::types::list*>(&field->get_type()) != nullptr)
+					{
+						throw xcl::errors::xcl_runtime_error(std::format("The field `{}` of `{}` is a list, which has no value syntax in a section.", field->get_name(), section->get_name()));
+					}
+				}
+				check_unique(field_names, std::format("`{}`", section->get_name()));
+			}
+			type_names.push_back(document_name_);
+			check_unique(type_names, "the schema");
+			check_unique(requireds_ | views::keys, "the required definitions");
+		}
+
+		// a declared type is qualified, since a member may have the name of its type, as in `mode mode`
+		[[nodiscard]] std::string get_cpp_type(const xcl::types::type& type) const
+		{
+			if (dynamic_cast<const xcl::types::number*>(&type) != nullptr)
+				return "long";
+			if (dynamic_cast<const xcl::types::boolean*>(&type) != nullptr)
+				return "bool";
+			if (dynamic_cast<const xcl::types::string*>(&type) != nullptr)
+				return "std::string";
+			if (collected_.contains(&type))
+				return std::format("::{}::{}", namespace_name_, to_snake_case(type.get_name()));
+			throw xcl::errors::type_not_found_error(type.get_name());
+		}
+
+		// the expression reading a scalar of the type from the token
+		[[nodiscard]] std::string get_scalar_parser(const xcl::types::type& type, const std::string_view token) const
+		{
+			if (dynamic_cast<const xcl::types::number*>(&type) != nullptr)
+				return std::format("xcl::generated::parse_integer({})", token);
+			if (dynamic_cast<const xcl::types::boolean*>(&type) != nullptr)
+				return std::format("xcl::generated::parse_boolean({})", token);
+			if (dynamic_cast<const xcl::types::string*>(&type) != nullptr)
+				return std::format("xcl::generated::parse_string({})", token);
+			return std::format("parse_{}({})", to_snake_case(type.get_name()), token);
+		}
+
+		[[nodiscard]] std::string format_value(const xcl::value& value) const
+		{
+			switch (value.get_kind())
+			{
+			case xcl::integer_value:
+				return std::to_string(value.as_integer());
+			case xcl::boolean_value:
+				return value.as_boolean() ? "true" : "false";
+			case xcl::string_value:
+				return quote(value.as_string());
+			case xcl::enumeration_value:
+				return std::format("{}::{}", get_cpp_type(value.get_type()), to_snake_case(value.as_enumeration_name()));
+			default:
+				return {};
+			}
+		}
+
+		void write_line(const int indentation, const std::string_view line)
+		{
+			if (!line.empty())
+				code_.append(indentation, '\t');
+			code_ += line;
+			code_ += '\n';
+		}
+
+		void write_enumeration_type(const xcl::types::enumeration& enumeration)
+		{
+			write_line(1, std::format("enum class {}", to_snake_case(enumeration.get_name())));
+			write_line(1, "{");
+			for (const auto& value : enumeration.get_values())
+				write_line(2, std::format("{},", to_snake_case(value)));
+			write_line(1, "};");
+			write_line(0, "");
+		}
+
+		void write_section_type(const xcl::types::section& section)
+		{
+			write_line(1, std::format("struct {}", to_snake_case(section.get_name())));
+			write_line(1, "{");
+			for (const auto& field : section.get_fields())
+				write_line(2, std::format("{} {}{{{}}};", get_cpp_type(field->get_type()), to_snake_case(field->get_name()), format_value(field->get_default_value())));
+			write_line(1, "};");
+			write_line(0, "");
+		}
+
+		void write_document_type()
+		{
+			write_line(1, "// the required definitions of the schema");
+			write_line(1, std::format("struct {}", document_name_));
+			write_line(1, "{");
+			for (const auto& [name, type] : requireds_)
+				write_line(2, std::format("{} {}{{}};", get_cpp_type(*type), to_snake_case(name)));
+			write_line(1, "};");
+			write_line(0, "");
+		}
+
+		void write_enumeration_parser(const xcl::types::enumeration& enumeration)
+		{
+			const auto type = to_snake_case(enumeration.get_name());
+			const auto [seed, size] = find_perfect_hash(enumeration.get_values(), enumeration.get_name());
+			vector<string> slots(size, "{ \"\", {} }");
+			for (const auto& value : enumeration.get_values())
+				slots[xcl::generated::hash_name(value, seed) & (size - 1)] = std::format("{{ {}, {}::{} }}", quote(value), type, to_snake_case(value));
+
+			write_line(1, std::format("inline {} parse_{}(const xcl::parser::token& token)", type, type));
+			write_line(1, "{");
+			write_line(2, "// every value has a slot of its own in the table, so a name is found with one hash and one comparison");
+			write_line(2, std::format("static constexpr std::array<std::pair<std::string_view, {}>, {}> values{{ {{", type, size));
+			for (const auto& slot : slots)
+				write_line(3, std::format("{},", slot));
+			write_line(2, "} };");
+			write_line(0, "");
+			write_line(2, "if (token.get_type() != xcl::parser::identifier)");
+			write_line(3, "throw xcl::errors::unexpected_token_error(token);");
+			write_line(2, std::format("const auto& [name, value] = values[xcl::generated::hash_name(token.get_text(), {:#x}ull) & {}];", seed, size - 1));
+			write_line(2, "if (name != token.get_text())");
+			write_line(3, std::format("xcl::generated::throw_member_not_found(token.get_text(), {});", quote(enumeration.get_name())));
+			write_line(2, "return value;");
+			write_line(1, "}");
+			write_line(0, "");
+		}
+
+		void write_list_parser(const xcl::types::list& list)
+		{
+			const auto type = to_snake_case(list.get_name());
+			write_line(1, std::format("inline void parse_{}(xcl::parser::source_token_stream& tokens, {}& result)", type, type));
+			write_line(1, "{");
+			write_line(2, "// syntax: { <Value>, <Value>, ... }");
+			write_line(0, "");
+			write_line(2, "result.clear();");
+			write_line(2, "xcl::binding_parser::parse_members(tokens, [&](xcl::parser::token_stream&)");
+			write_line(2, "{");
+			write_line(3, std::format("result.push_back({});", get_scalar_parser(list.get_contained_type(), "tokens.current()")));
+			write_line(3, "tokens.advance();");
+			write_line(2, "});");
+			write_line(1, "}");
+			write_line(0, "");
+		}
+
+		void write_section_parser(const xcl::types::section& section)
+		{
+			const auto type = to_snake_case(section.get_name());
+			write_line(1, std::format("inline void parse_{}(xcl::parser::source_token_stream& tokens, {}& result)", type, type));
+			write_line(1, "{");
+			write_line(2, "// syntax: { <Identifier> = <Value>, <Identifier> = <Value>, ... }");
+			write_line(0, "");
+			write_line(2, "result = {};");
+			for (const auto& field : section.get_fields())
+			{
+				if (!field->has_default_value())
+					write_line(2, std::format("auto has_{} = false;", to_snake_case(field->get_name())));
+			}
+			write_line(2, "xcl::binding_parser::parse_members(tokens, [&](xcl::parser::token_stream&)");
+			write_line(2, "{");
+			write_line(3, "const auto name = xcl::generated::parse_field_name(tokens);");
+			write_line(3, "switch (xcl::generated::hash_name(name))");
+			write_line(3, "{");
+
+			map<uint64_t, vector<const xcl::types::section::field*>> cases;
+			for (const auto& field : section.get_fields())
+				cases[xcl::generated::hash_name(field->get_name())].push_back(field.get());
+			for (const auto& fields : cases | views::values)
+			{
+				write_line(3, std::format("case xcl::generated::hash_name({}):", quote(fields.front()->get_name())));
+				for (const auto field : fields)
+				{
+					const auto member = to_snake_case(field->get_name());
+					write_line(4, std::format("if (name == {})", quote(field->get_name())));
+					write_line(4, "{");
+					write_line(5, std::format("result.{} = {};", member, get_scalar_parser(field->get_type(), "tokens.current()")));
+					if (!field->has_default_value())
+						write_line(5, std::format("has_{} = true;", member));
+					write_line(5, "break;");
+					write_line(4, "}");
+				}
+				write_line(4, std::format("xcl::generated::throw_member_not_found(name, {});", quote(section.get_name())));
+			}
+			write_line(3, "default:");
+			write_line(4, std::format("xcl::generated::throw_member_not_found(name, {});", quote(section.get_name())));
+			write_line(3, "}");
+			write_line(3, "tokens.advance();");
+			write_line(2, "});");
+
+			for (const auto& field : section.get_fields())
+			{
+				if (field->has_default_value())
+					continue;
+				write_line(0, "");
+				write_line(2, std::format("if (!has_{})", to_snake_case(field->get_name())));
+				write_line(3, std::format("throw xcl::errors::required_field_not_set_error({}, {});", quote(field->get_name()), quote(section.get_name())));
+			}
+			write_line(1, "}");
+			write_line(0, "");
+		}
+
+		// the statements parsing a value of the type into the target after the name of its definition, without a target the value is dropped
+		void write_value_parser(const int indentation, const xcl::types::type& type, const std::string_view target)
+		{
+			if (dynamic_cast<const xcl::types::section*>(&type) != nullptr || dynamic_cast<const xcl::types::list*>(&type) != nullptr)
+			{
+				if (target.empty())
+					write_line(indentation, std::format("{} value;", get_cpp_type(type)));
+				write_line(indentation, std::format("parse_{}(tokens, {});", to_snake_case(type.get_name()), target.empty() ? "value" : target));
+				return;
+			}
+			write_line(indentation, "xcl::generated::expect_scalar_value(tokens);");
+			if (target.empty())
+				write_line(indentation, std::format("(void){};", get_scalar_parser(type, "tokens.current()")));
+			else
+				write_line(indentation, std::format("{} = {};", target, get_scalar_parser(type, "tokens.current()")));
+			write_line(indentation, "tokens.advance();");
+			write_line(indentation, "xcl::binding_parser::expect(tokens, xcl::parser::new_line);");
+		}
+
+		// every type is named in the switch, since a definition may use a type without it being declared by the schema itself
+		void write_definition_skipper()
+		{
+			vector<const xcl::types::type*> types{ xcl::types::number::get_instance().get(), xcl::types::boolean::get_instance().get(), xcl::types::string::get_instance().get() };
+			types.insert(types.end(), enumerations_.begin(), enumerations_.end());
+			types.insert(types.end(), lists_.begin(), lists_.end());
+			types.insert(types.end(), sections_.begin(), sections_.end());
+
+			write_line(1, "inline bool is_type(const std::string_view name)");
+			write_line(1, "{");
+			write_line(2, "static constexpr std::string_view names[] = {");
+			for (const auto type : types)
+				write_line(3, std::format("{},", quote(type->get_name())));
+			write_line(2, "};");
+			write_line(2, "return std::ranges::find(names, name) != std::end(names);");
+			write_line(1, "}");
+			write_line(0, "");
+
+			write_line(1, "// checks the value of a definition that is not required and drops it");
+			write_line(1, "inline void skip_definition(xcl::parser::source_token_stream& tokens, const std::string_view type_name)");
+			write_line(1, "{");
+			write_line(2, "switch (xcl::generated::hash_name(type_name))");
+			write_line(2, "{");
+			map<uint64_t, vector<const xcl::types::type*>> cases;
+			for (const auto type : types)
+				cases[xcl::generated::hash_name(type->get_name())].push_back(type);
+			for (const auto& case_types : cases | views::values)
+			{
+				write_line(2, std::format("case xcl::generated::hash_name({}):", quote(case_types.front()->get_name())));
+				for (const auto type : case_types)
+				{
+					write_line(3, std::format("if (type_name == {})", quote(type->get_name())));
+					write_line(3, "{");
+					write_value_parser(4, *type, {});
+					write_line(4, "return;");
+					write_line(3, "}");
+				}
+				write_line(3, "break;");
+			}
+			write_line(2, "default:");
+			write_line(3, "break;");
+			write_line(2, "}");
+			write_line(2, "throw xcl::errors::type_not_found_error(std::string(type_name));");
+			write_line(1, "}");
+			write_line(0, "");
+		}
+
+		void write_document_parser()
+		{
+			write_line(1, "// the schema is compiled in, so the imports of the data file are skipped and the types are never looked up");
+			write_line(1, "// the definitions that are not required are checked and dropped");
+			write_line(1, std::format("inline {} parse_{}(const std::string_view source)", document_name_, document_name_));
+			write_line(1, "{");
+			write_line(2, "xcl::parser::source_token_stream tokens(source);");
+			write_line(2, std::format("{} result;", document_name_));
+			for (const auto& name : requireds_ | views::keys)
+				write_line(2, std::format("auto has_{} = false;", to_snake_case(name)));
+			write_line(2, "try");
+			write_line(2, "{");
+			write_line(3, "while (!tokens.at_end())");
+			write_line(3, "{");
+			write_line(4, "if (tokens.current().get_type() == xcl::parser::new_line)");
+			write_line(4, "{");
+			write_line(5, "tokens.advance();");
+			write_line(5, "continue;");
+			write_line(4, "}");
+			write_line(4, "if (tokens.current().get_keyword() == xcl::parser::import_keyword)");
+			write_line(4, "{");
+			write_line(5, "xcl::generated::skip_import(tokens);");
+			write_line(5, "continue;");
+			write_line(4, "}");
+			write_line(0, "");
+			write_line(4, "// syntax: <Identifier(Required Name)> <Value> | <Identifier(Type Name)> <Identifier> <Value>");
+			write_line(4, "xcl::binding_parser::expect(tokens, xcl::parser::identifier);");
+			write_line(4, "auto name = tokens.current().get_text();");
+			write_line(4, "std::string_view type_name;");
+			write_line(4, "tokens.advance();");
+			write_line(4, "if (!tokens.at_end() && tokens.current().get_type() == xcl::parser::identifier)");
+			write_line(4, "{");
+			write_line(5, "type_name = std::exchange(name, tokens.current().get_text());");
+			write_line(5, "tokens.advance();");
+			write_line(4, "}");
+			write_line(0, "");
+
+			if (!requireds_.empty())
+			{
+				write_line(4, "switch (xcl::generated::hash_name(name))");
+				write_line(4, "{");
+				map<uint64_t, vector<pair<string, const xcl::types::type*>>> cases;
+				for (const auto& [name, type] : requireds_)
+					cases[xcl::generated::hash_name(name)].emplace_back(name, type);
+				for (const auto& definitions : cases | views::values)
+				{
+					write_line(4, std::format("case xcl::generated::hash_name({}):", quote(definitions.front().first)));
+					for (const auto& [name, type] : definitions)
+					{
+						const auto member = to_snake_case(name);
+						write_line(5, std::format("if (name == {})", quote(name)));
+						write_line(5, "{");
+						write_line(6, std::format("if (!type_name.empty() && type_name != {})", quote(type->get_name())));
+						write_line(7, std::format("throw xcl::errors::xcl_runtime_error(xcl::generated::format_type_mismatch(type_name, {}));", quote(type->get_name())));
+						write_value_parser(6, *type, std::format("result.{}", member));
+						write_line(6, std::format("has_{} = true;", member));
+						write_line(6, "continue;");
+						write_line(5, "}");
+					}
+					write_line(5, "break;");
+				}
+				write_line(4, "default:");
+				write_line(5, "break;");
+				write_line(4, "}");
+				write_line(0, "");
+			}
+
+			write_line(4, "// a name that is not required must follow the name of its type");
+			write_line(4, "if (type_name.empty())");
+			write_line(4, "{");
+			write_line(5, "if (!is_type(name))");
+			write_line(6, "throw xcl::errors::type_not_found_error(std::string(name));");
+			write_line(5, "xcl::binding_parser::expect(tokens, xcl::parser::identifier);");
+			write_line(4, "}");
+			write_line(4, "skip_definition(tokens, type_name);");
+			write_line(3, "}");
+			write_line(2, "}");
+			write_line(2, "catch (xcl::errors::token_error& error)");
+			write_line(2, "{");
+			write_line(3, "xcl::binding_parser::locate_error(error, tokens);");
+			write_line(3, "throw;");
+			write_line(2, "}");
+
+			for (const auto& name : requireds_ | views::keys)
+			{
+				write_line(0, "");
+				write_line(2, std::format("if (!has_{})", to_snake_case(name)));
+				write_line(3, std::format("throw xcl::errors::xcl_runtime_error({});", quote(std::format("The required value `{}` is not defined.", name))));
+			}
+			write_line(2, "return result;");
+			write_line(1, "}");
+			write_line(0, "");
+		}
+
+		void write_enumeration_schema(const xcl::types::enumeration& enumeration)
+		{
+			const auto type = std::format("{}::{}", namespace_name_, to_snake_case(enumeration.get_name()));
+			write_line(0, "template <>");
+			write_line(0, std::format("struct xcl::schema<{}>", type));
+			write_line(0, "{");
+			write_line(1, std::format("static constexpr std::string_view type_name = {};", quote(enumeration.get_name())));
+			write_line(1, std::format("static constexpr auto values = std::to_array<xcl::enumerator_schema<{}>>({{", type));
+			for (const auto& value : enumeration.get_values())
+				write_line(2, std::format("{{ {}, {}::{} }},", quote(value), type, to_snake_case(value)));
+			write_line(1, "});");
+			write_line(0, "};");
+			write_line(0, "");
+		}
+
+		void write_section_schema(const xcl::types::section& section)
+		{
+			const auto type = std::format("{}::{}", namespace_name_, to_snake_case(section.get_name()));
+			write_line(0, "template <>");
+			write_line(0, std::format("struct xcl::schema<{}>", type));
+			write_line(0, "{");
+			write_line(1, std::format("static constexpr std::string_view type_name = {};", quote(section.get_name())));
+			write_line(1, "static constexpr auto fields = std::make_tuple(");
+			for (size_t index = 0; index < section.get_fields().size(); ++index)
+			{
+				const auto& field = *section.get_fields()[index];
+				write_line(2, std::format("xcl::bind_field({}, &{}::{}){}", quote(field.get_name()), type, to_snake_case(field.get_name()), index + 1 < section.get_fields().size() ? "," : ");"));
+			}
+			if (section.get_fields().empty())
+				write_line(1, ");");
+			write_line(0, "};");
+			write_line(0, "");
+		}
+
+		std::string namespace_name_;
+		std::string document_name_;
+		std::string code_;
+
+		unordered_set<const xcl::types::type*> collected_;
+		vector<const xcl::types::enumeration*> enumerations_;
+		vector<const xcl::types::section*> sections_;
+		vector<const xcl::types::list*> lists_;
+		map<string, const xcl::types::type*> requireds_;
+	};
+}
+
+std::string xcl::generate_parser(const document& schema, const std::string_view namespace_name, const std::string_view document_name)
+{
+	return parser_generator(schema, namespace_name, document_name).generate();
+}
@@ -0,0 +1,15 @@
+﻿#pragma once
+
+#include <string>
+#include <string_view>
+
+#include "document.h"
+
+namespace xcl
+{
+	// emits a C++ header for the custom types and required definitions of a schema document and of its imports:
+	// a struct for every section, an enum class for every enumeration, a vector for every list and their bindings,
+	// and a parser specialized to the schema, which dispatches on hashes computed at compile time instead of resolving names
+	// the generated parse_<document_name> reads a data file into a struct holding the required definitions
+	[[nodiscard]] std::string generate_parser(const document& schema, std::string_view namespace_name, std::string_view document_name);
+}
@@ -1,74 +1,144 @@
 ﻿#include "pch.h"
 #include "section.h"
 
+#include <bit>
+
 #include "exception.h"
 
 using namespace std;
 
-void xcl::types::section::add_field(string name, const type& type,
-	unique_ptr<xcl::objects::object> default_value)
+void xcl::types::section::add_field(std::string name, const type& type,
+	const xcl::value& default_value)
+{
+	if (slots_.contains(name))
+	{
+		throw errors::xcl_runtime_error(std::format("The field `{}` is already defined in section `{}`.", name, get_name()));
+	}
+
+	const auto slot = fields_.size();
+	const auto& field = *fields_.emplace_back(make_unique<xcl::types::section::field>(move(name), type, default_value));
+	slots_.emplace(field.get_name(), slot);
+
+	if (required_mask_.size() * 64 <= slot)
+	{
+		required_mask_.push_back(0);
+	}
+	if (default_value.is_empty())
+	{
+		required_mask_[slot / 64] |= uint64_t{1} << slot % 64;
+	}
+	defaults_.push_back(default_value);
+}
+
+size_t xcl::types::section::resolve_slot(const string_view name) const
+{
+	if (const auto slot = find_slot(name))
+	{
+		return *slot;
+	}
+	throw errors::member_not_found_error(std::string(name), get_name());
+}
+
+std::optional<size_t> xcl::types::section::find_slot(const string_view name) const noexcept
+{
+	if (const auto slot = slots_.find(name); slot != slots_.end())
+	{
+		return slot->second;
+	}
+	return nullopt;
+}
+
+void xcl::types::section::check_required_fields(const xcl::objects::section& value) const
 {
-	fields_.push_back(make_unique<field>(move(name), type, move(default_value)));
+	for (size_t word = 0; word < required_mask_.size(); ++word)
+	{
+		for (auto missing = required_mask_[word]; missing != 0; missing &= missing - 1)
+		{
+			if (const auto slot = word * 64 + countr_zero(missing); !value.has_value(slot))
+			{
+				throw errors::required_field_not_set_error(fields_[slot]->get_name(), get_name());
+			}
+		}
+	}
 }
 
-const xcl::types::section::field& xcl::types::section::resolve_field(const string& name) const
+void xcl::types::section::check_required_fields(const std::span<const uint64_t> set_slots) const
 {
-	for (const auto& field : fields_)
+	for (size_t word = 0; word < required_mask_.size(); ++word)
 	{
-		if (field->get_name() == name)
+		if (const auto missing = required_mask_[word] & ~(word < set_slots.size() ? set_slots[word] : 0); missing != 0)
 		{
-			return *field;
+			throw errors::required_field_not_set_error(fields_[word * 64 + countr_zero(missing)]->get_name(), get_name());
 		}
 	}
-	throw errors::member_not_found_error(name, get_name());
 }
 
-unique_ptr<xcl::objects::section> xcl::types::section::activate() const noexcept
+xcl::objects::section* xcl::types::section::activate(std::pmr::memory_resource& arena) const
 {
-	return make_unique<xcl::objects::section>(*this);
+	return objects::allocate_object<xcl::objects::section>(arena, *this, arena);
 }
 
-std::unique_ptr<xcl::objects::object> xcl::types::section::activate(const xcl::parser::token&) const
+xcl::value xcl::types::section::activate(const xcl::parser::token&, std::pmr::memory_resource& arena) const
 {
-	return activate();
+	return xcl::value(*activate(arena));
 }
 
-const xcl::objects::object& xcl::objects::section::get_value(const std::string& field_name) const
+const xcl::value& xcl::objects::section::get_value(const std::string_view field_name) const
 {
-	if (values_.contains(field_name))
-		return *values_.at(field_name);
-	const auto& type = dynamic_cast<const xcl::types::section&>(get_type());
-	const auto& field = type.resolve_field(field_name);
-	return field.get_default_value();
+	return get_value(static_cast<const xcl::types::section&>(get_type()).resolve_slot(field_name));
 }
 
-void xcl::objects::section::set_value(const std::string& field_name, unique_ptr<xcl::objects::object> value)
+const xcl::value& xcl::objects::section::get_value(const size_t slot) const
 {
-	values_[field_name] = move(value);
+	if (const auto& value = find_value(slot); !value.is_empty())
+		return value;
+	const auto& type = static_cast<const xcl::types::section&>(get_type());
+	throw errors::required_field_not_set_error(type.get_fields()[slot]->get_name(), type.get_name());
 }
 
-unique_ptr<xcl::objects::object> xcl::objects::section::clone() const
+const xcl::value& xcl::objects::section::find_value(const size_t slot) const noexcept
 {
-	return make_unique<xcl::objects::section>(dynamic_cast<const xcl::types::section&>(get_type()), values_);
+	if (!values_[slot].is_empty())
+		return values_[slot];
+	return static_cast<const xcl::types::section&>(get_type()).get_default_value(slot);
 }
 
-std::string xcl::objects::section::to_string() const
+size_t xcl::objects::section::compute_hash() const noexcept
 {
-	string result{"{ "};
-	const auto& type = dynamic_cast<const xcl::types::section&>(get_type());
-	for (const auto& field : type.get_fields())
+	// a value equal to the default hashes like the default, whether it was set or not
+	const auto& type = static_cast<const xcl::types::section&>(get_type());
+	auto result = type.get_name_hash();
+	for (size_t slot = 0; slot < values_.size(); ++slot)
 	{
-		result += std::format("{} = {}, ", field->get_name(), get_value(field->get_name()).to_string());
+		result = hash_combine(result, std::hash<std::string>{}(type.get_fields()[slot]->get_name()));
+		result = hash_combine(result, find_value(slot).get_hash());
 	}
-	result += "}";
 	return result;
 }
 
-xcl::objects::section::section(const xcl::types::section& type,
-                               const std::unordered_map<std::string, std::unique_ptr<xcl::objects::object>>& values) : object(type)
+void xcl::objects::section::set_value(const std::string_view field_name, const xcl::value& value)
+{
+	set_value(static_cast<const xcl::types::section&>(get_type()).resolve_slot(field_name), value);
+}
+
+xcl::objects::object* xcl::objects::section::clone(std::pmr::memory_resource& arena) const
 {
-	for (const auto& [field_name, value] : values)
+	auto result = allocate_object<section>(arena, static_cast<const xcl::types::section&>(get_type()), arena);
+	for (size_t slot = 0; slot < values_.size(); ++slot)
 	{
-		set_value(field_name, value->clone());
+		result->values_[slot] = values_[slot].clone(arena);
 	}
+	return result;
+}
+
+std::string xcl::objects::section::to_string() const
+{
+	string result{"{ "};
+	const auto& type = static_cast<const xcl::types::section&>(get_type());
+	for (size_t slot = 0; slot < values_.size(); ++slot)
+	{
+		result += std::format("{} = {}, ", type.get_fields()[slot]->get_name(), get_value(slot).to_string());
+	}
+	result += "}";
+	return result;
 }
@@ -1,7 +1,11 @@
 ﻿#pragma once
 
-#include <unordered_map>
+#include <cstdint>
+#include <optional>
+#include <span>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "object.h"
 #include "type.h"
@@ -19,34 +23,47 @@ namespace xcl::types
 		class field
 		{
 		public:
-			field(std::string name, const type& type, std::unique_ptr<xcl::objects::object> default_value) : name_(std::move(name)), type_(type), default_value_(std::move(default_value)) {}
+			field(std::string name, const type& type, const xcl::value& default_value) : name_(std::move(name)), type_(type), default_value_(default_value) {}
 
 			[[nodiscard]] const std::string& get_name() const noexcept { return name_; }
 			[[nodiscard]] const type& get_type() const noexcept { return type_; }
-			[[nodiscard]] const xcl::objects::object& get_default_value() const noexcept { return *default_value_; }
+			[[nodiscard]] const xcl::value& get_default_value() const noexcept { return default_value_; }
 
-			[[nodiscard]] bool has_default_value() const { return default_value_ != nullptr; }
+			[[nodiscard]] bool has_default_value() const { return !default_value_.is_empty(); }
 
 		private:
 			std::string name_;
 			const type& type_;
-			std::unique_ptr<xcl::objects::object> default_value_;
+			xcl::value default_value_;
 		};
 
 		explicit section(std::string name) : type(std::move(name)) {}
 
-		void add_field(std::string name, const type& type, std::unique_ptr<xcl::objects::object> default_value);
+		void add_field(std::string name, const type& type, const xcl::value& default_value);
 
 		[[nodiscard]] const std::vector<std::unique_ptr<field>>& get_fields() const noexcept { return fields_; }
 
-		[[nodiscard]] const field& resolve_field(const std::string& name) const;
+		[[nodiscard]] const field& resolve_field(std::string_view name) const { return *fields_[resolve_slot(name)]; }
+
+		// fields are compiled into slots in declaration order, values of the section are stored by slot
+		[[nodiscard]] size_t resolve_slot(std::string_view name) const;
+		[[nodiscard]] std::optional<size_t> find_slot(std::string_view name) const noexcept;
+
+		[[nodiscard]] const xcl::value& get_default_value(const size_t slot) const noexcept { return defaults_[slot]; }
+
+		void check_required_fields(const xcl::objects::section& value) const;
+		// a bit is set for every slot that was set, in words of 64 slots
+		void check_required_fields(std::span<const uint64_t> set_slots) const;
 
-		[[nodiscard]] std::unique_ptr<xcl::objects::section> activate() const noexcept;
+		[[nodiscard]] xcl::objects::section* activate(std::pmr::memory_resource& arena) const;
 
-		[[nodiscard]] std::unique_ptr<xcl::objects::object> activate(const xcl::parser::token&) const override;
+		[[nodiscard]] xcl::value activate(const xcl::parser::token&, std::pmr::memory_resource& arena) const override;
 
 	private:
 		std::vector<std::unique_ptr<field>> fields_;
+		std::unordered_map<std::string_view, size_t> slots_;
+		std::vector<uint64_t> required_mask_;
+		std::vector<xcl::value> defaults_;
 	};
 }
 
@@ -55,18 +72,31 @@ namespace xcl::objects
 	class section final : public object
 	{
 	public:
-		explicit section(const xcl::types::section& type) : object(type) {}
-		section(const xcl::types::section& type, const std::unordered_map<std::string, std::unique_ptr<xcl::objects::object>>& values);
+		section(const xcl::types::section& type, std::pmr::memory_resource& arena) : object(type), values_(type.get_fields().size(), &arena) {}
 
-		[[nodiscard]] const xcl::objects::object& get_value(const std::string& field_name) const;
+		[[nodiscard]] const xcl::value& get_value(std::string_view field_name) const;
+		[[nodiscard]] const xcl::value& get_value(size_t slot) const;
 
-		void set_value(const std::string& field_name, std::unique_ptr<xcl::objects::object> value);
+		// the value set for the slot or else its default, empty for a required field that is not set
+		[[nodiscard]] const xcl::value& find_value(size_t slot) const noexcept;
 
-		[[nodiscard]] std::unique_ptr<xcl::objects::object> clone() const override;
+		[[nodiscard]] bool has_value(const size_t slot) const noexcept { return !values_[slot].is_empty(); }
+
+		void set_value(std::string_view field_name, const xcl::value& value);
+		void set_value(const size_t slot, const xcl::value& value) noexcept
+		{
+			values_[slot] = value;
+			reset_hash();
+		}
+
+		[[nodiscard]] xcl::objects::object* clone(std::pmr::memory_resource& arena) const override;
 
 		[[nodiscard]] std::string to_string() const override;
 
+	protected:
+		[[nodiscard]] size_t compute_hash() const noexcept override;
+
 	private:
-		std::unordered_map<std::string, std::unique_ptr<xcl::objects::object>> values_;
+		std::pmr::vector<xcl::value> values_;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,170 @@
+﻿#include "pch.h"
+#include "shared_memory.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <format>
+
+#include "exception.h"
+
+using namespace std;
+
+std::string xcl::shared_memory::get_system_name(const std::string_view name)
+{
+	if (name.empty() || name.find_first_of("/\\") != string_view::npos)
+	{
+		throw errors::xcl_runtime_error(std::format("`{}` is not a valid name for shared memory.", name));
+	}
+#ifdef _WIN32
+	return string(name);
+#else
+	return std::format("/{}", name);
+#endif
+}
+
+#ifdef _WIN32
+
+xcl::shared_memory xcl::shared_memory::create(const std::string_view name, const size_t size)
+{
+	const auto system_name = get_system_name(name);
+	const auto mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, static_cast<DWORD>(static_cast<uint64_t>(size) >> 32), static_cast<DWORD>(size), system_name.c_str());
+	if (mapping == nullptr)
+	{
+		throw errors::xcl_runtime_error(std::format("The shared memory `{}` could not be created.", name));
+	}
+
+	shared_memory result;
+	result.handle_ = mapping;
+	result.data_ = static_cast<char*>(MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, size));
+	if (result.data_ == nullptr)
+	{
+		throw errors::xcl_runtime_error(std::format("The shared memory `{}` could not be mapped.", name));
+	}
+	result.size_ = size;
+	return result;
+}
+
+xcl::shared_memory xcl::shared_memory::open(const std::string_view name)
+{
+	const auto system_name = get_system_name(name);
+	const auto mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, system_name.c_str());
+	if (mapping == nullptr)
+	{
+		throw errors::xcl_runtime_error(std::format("The shared memory `{}` could not be opened.", name));
+	}
+
+	shared_memory result;
+	result.handle_ = mapping;
+	result.data_ = static_cast<char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+	MEMORY_BASIC_INFORMATION region{};
+	if (result.data_ == nullptr || VirtualQuery(result.data_, &region, sizeof region) == 0)
+	{
+		throw errors::xcl_runtime_error(std::format("The shared memory `{}` could not be mapped.", name));
+	}
+	result.size_ = region.RegionSize;
+	return result;
+}
+
+void xcl::shared_memory::remove(std::string_view) noexcept
+{
+	// the segment is gone once the last handle to it is closed
+}
+
+xcl::shared_memory::~shared_memory()
+{
+	if (data_ != nullptr)
+	{
+		UnmapViewOfFile(data_);
+	}
+	if (handle_ != nullptr)
+	{
+		CloseHandle(handle_);
+	}
+}
+
+#else
+
+xcl::shared_memory xcl::shared_memory::create(const std::string_view name, const size_t size)
+{
+	const auto system_name = get_system_name(name);
+	const auto file = shm_open(system_name.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+	if (file == -1 || ftruncate(file, static_cast<off_t>(size)) == -1)
+	{
+		if (file != -1)
+			close(file);
+		throw errors::xcl_runtime_error(std::format("The shared memory `{}` could not be created.", name));
+	}
+
+	const auto data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+	// the mapping stays valid after the descriptor is closed
+	close(file);
+	if (data == MAP_FAILED)
+	{
+		throw errors::xcl_runtime_error(std::format("The shared memory `{}` could not be mapped.", name));
+	}
+
+	shared_memory result;
+	result.data_ = static_cast<char*>(data);
+	result.size_ = size;
+	return result;
+}
+
+xcl::shared_memory xcl::shared_memory::open(const std::string_view name)
+{
+	const auto system_name = get_system_name(name);
+	const auto file = shm_open(system_name.c_str(), O_RDONLY | O_CLOEXEC, 0);
+	if (file == -1)
+	{
+		throw errors::xcl_runtime_error(std::format("The shared memory `{}` could not be opened.", name));
+	}
+
+	struct stat status{};
+	if (fstat(file, &status) == -1 || status.st_size == 0)
+	{
+		close(file);
+		throw errors::xcl_runtime_error(std::format("The shared memory `{}` could not be read.", name));
+	}
+
+	const auto data = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_SHARED, file, 0);
+	close(file);
+	if (data == MAP_FAILED)
+	{
+		throw errors::xcl_runtime_error(std::format("The shared memory `{}` could not be mapped.", name));
+	}
+
+	shared_memory result;
+	result.data_ = static_cast<char*>(data);
+	result.size_ = static_cast<size_t>(status.st_size);
+	return result;
+}
+
+void xcl::shared_memory::remove(const std::string_view name) noexcept
+{
+	if (name.empty() || name.find_first_of("/\\") != string_view::npos)
+		return;
+	shm_unlink(std::format("/{}", name).c_str());
+}
+
+xcl::shared_memory::~shared_memory()
+{
+	if (data_ != nullptr)
+	{
+		munmap(data_, size_);
+	}
+}
+
+#endif
+
+xcl::shared_memory::shared_memory(shared_memory&& other) noexcept : data_(other.data_), size_(other.size_), handle_(other.handle_)
+{
+	other.data_ = nullptr;
+	other.size_ = 0;
+	other.handle_ = nullptr;
+}
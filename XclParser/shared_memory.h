@@ -0,0 +1,42 @@
+﻿#pragma once
+
+#include <string>
+#include <string_view>
+
+namespace xcl
+{
+	// mapping of a named shared memory segment, the segment stays mapped as long as the object is alive
+	class shared_memory
+	{
+	public:
+		// creates the segment or opens it for writing when it exists, a new segment is zeroed
+		[[nodiscard]] static shared_memory create(std::string_view name, size_t size);
+
+		// opens an existing segment for reading
+		[[nodiscard]] static shared_memory open(std::string_view name);
+
+		// removes the name, processes that mapped the segment keep it until they unmap it
+		static void remove(std::string_view name) noexcept;
+
+		shared_memory(const shared_memory&) = delete;
+		shared_memory(shared_memory&& other) noexcept;
+		~shared_memory();
+
+		[[nodiscard]] char* get_data() const noexcept { return data_; }
+		// may be rounded up to whole pages
+		[[nodiscard]] size_t get_size() const noexcept { return size_; }
+
+		shared_memory& operator=(const shared_memory&) = delete;
+		shared_memory& operator=(shared_memory&&) = delete;
+
+	private:
+		shared_memory() = default;
+
+		[[nodiscard]] static std::string get_system_name(std::string_view name);
+
+		char* data_{nullptr};
+		size_t size_{0};
+		// the segment of a name lives as long as a handle to it is open on windows
+		void* handle_{nullptr};
+	};
+}
@@ -0,0 +1,164 @@
+﻿#include "pch.h"
+#include "shared_snapshot.h"
+
+#include <atomic>
+#include <cstring>
+#include <format>
+
+#include "exception.h"
+
+using namespace std;
+
+namespace
+{
+	constexpr char control_magic[4] = { 'X', 'C', 'L', 'S' };
+	constexpr uint32_t control_version = 1;
+
+	struct control_block
+	{
+		char magic[4];
+		uint32_t version;
+		uint64_t generation;
+	};
+
+	// a segment holds the size of the image followed by the image, the mapping may be rounded up to whole pages
+	struct segment_header
+	{
+		uint64_t size;
+	};
+
+	static_assert(std::atomic_ref<uint64_t>::is_always_lock_free, "the generation must be shared without locks");
+
+	std::string get_segment_name(const std::string_view name, const uint64_t generation)
+	{
+		return std::format("{}.{}", name, generation);
+	}
+
+	std::atomic_ref<uint64_t> get_generation_ref(const xcl::shared_memory& control) noexcept
+	{
+		return std::atomic_ref(reinterpret_cast<control_block*>(control.get_data())->generation);
+	}
+
+	std::string_view get_image(const xcl::shared_memory& segment)
+	{
+		if (segment.get_size() < sizeof(segment_header))
+		{
+			throw xcl::errors::xcl_runtime_error("The shared snapshot is damaged.");
+		}
+		const auto size = reinterpret_cast<const segment_header*>(segment.get_data())->size;
+		if (size > segment.get_size() - sizeof(segment_header))
+		{
+			throw xcl::errors::xcl_runtime_error("The shared snapshot is damaged.");
+		}
+		return { segment.get_data() + sizeof(segment_header), static_cast<size_t>(size) };
+	}
+
+	// the snapshot refers to the segment, so they are kept alive together
+	struct mapped_segment
+	{
+		explicit mapped_segment(xcl::shared_memory memory) : memory(std::move(memory)), image(get_image(this->memory)) {}
+
+		xcl::shared_memory memory;
+		xcl::snapshot image;
+	};
+}
+
+xcl::snapshot_publisher::snapshot_publisher(std::string name) : name_(std::move(name)), control_(shared_memory::create(name_, sizeof(control_block)))
+{
+	// a publisher that restarts continues with the generations of its predecessor
+	auto& control = *reinterpret_cast<control_block*>(control_.get_data());
+	if (memcmp(control.magic, control_magic, sizeof control_magic) != 0 || control.version != control_version)
+	{
+		control.version = control_version;
+		get_generation_ref(control_).store(0, memory_order_release);
+		memcpy(control.magic, control_magic, sizeof control_magic);
+	}
+	generation_ = get_generation_ref(control_).load(memory_order_acquire);
+}
+
+void xcl::snapshot_publisher::remove(const std::string& name) noexcept
+{
+	try
+	{
+		const auto control = shared_memory::open(name);
+		if (control.get_size() >= sizeof(control_block))
+		{
+			if (const auto generation = get_generation_ref(control).load(memory_order_acquire); generation != 0)
+			{
+				shared_memory::remove(get_segment_name(name, generation));
+			}
+		}
+	}
+	catch (const exception&)
+	{
+		// nothing is published under the name
+	}
+	shared_memory::remove(name);
+}
+
+uint64_t xcl::snapshot_publisher::publish(const document& document)
+{
+	const auto image = compile_snapshot(document);
+	const auto generation = generation_ + 1;
+	auto segment = shared_memory::create(get_segment_name(name_, generation), sizeof(segment_header) + image.size());
+	reinterpret_cast<segment_header*>(segment.get_data())->size = image.size();
+	memcpy(segment.get_data() + sizeof(segment_header), image.data(), image.size());
+
+	// the release makes the image visible to every subscriber that sees the new generation
+	get_generation_ref(control_).store(generation, memory_order_release);
+
+	// subscribers that still map the previous generation keep it, new ones can no longer open it
+	if (generation_ != 0)
+	{
+		shared_memory::remove(get_segment_name(name_, generation_));
+	}
+	image_.reset();
+	image_.emplace(std::move(segment));
+	generation_ = generation;
+	return generation;
+}
+
+xcl::snapshot_subscriber::snapshot_subscriber(std::string name) : name_(std::move(name)), control_(shared_memory::open(name_))
+{
+	const auto is_valid = [this]
+	{
+		if (control_.get_size() < sizeof(control_block))
+			return false;
+		const auto& control = *reinterpret_cast<const control_block*>(control_.get_data());
+		return memcmp(control.magic, control_magic, sizeof control_magic) == 0 && control.version == control_version;
+	};
+	if (!is_valid())
+	{
+		throw errors::xcl_runtime_error(std::format("The shared memory `{}` does not hold published snapshots.", name_));
+	}
+}
+
+uint64_t xcl::snapshot_subscriber::get_generation() const noexcept
+{
+	return get_generation_ref(control_).load(memory_order_acquire);
+}
+
+std::shared_ptr<const xcl::snapshot> xcl::snapshot_subscriber::get_snapshot()
+{
+	lock_guard lock(mutex_);
+	while (true)
+	{
+		const auto generation = get_generation();
+		if (generation == generation_)
+			return snapshot_;
+
+		try
+		{
+			const auto segment = make_shared<const mapped_segment>(shared_memory::open(get_segment_name(name_, generation)));
+			snapshot_ = shared_ptr<const snapshot>(segment, &segment->image);
+			generation_ = generation;
+			return snapshot_;
+		}
+		catch (const errors::xcl_exception&)
+		{
+			// the generation was replaced between reading it and opening its segment
+			if (get_generation() == generation)
+				throw;
+		}
+	}
+}
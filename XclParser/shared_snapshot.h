@@ -0,0 +1,73 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+
+#include "document.h"
+#include "shared_memory.h"
+#include "snapshot.h"
+
+namespace xcl
+{
+	// publishes compiled snapshots of a document to the processes of a host through named shared memory
+	// every generation gets a segment of its own, a small control segment holds the current generation
+	class snapshot_publisher
+	{
+	public:
+		// there must be one publisher per name
+		explicit snapshot_publisher(std::string name);
+		snapshot_publisher(const snapshot_publisher&) = delete;
+		snapshot_publisher(snapshot_publisher&&) = delete;
+		// the segments outlive the publisher, so subscribers stay attached to a publisher that restarts
+		~snapshot_publisher() = default;
+
+		// removes the segments of a name that is no longer published, subscribers keep the snapshots they already hold
+		static void remove(const std::string& name) noexcept;
+
+		// compiles the document into a new segment and makes it the current generation, which is returned
+		uint64_t publish(const document& document);
+
+		// zero until something is published
+		[[nodiscard]] uint64_t get_generation() const noexcept { return generation_; }
+
+		snapshot_publisher& operator=(const snapshot_publisher&) = delete;
+		snapshot_publisher& operator=(snapshot_publisher&&) = delete;
+
+	private:
+		std::string name_;
+		shared_memory control_;
+		std::optional<shared_memory> image_;
+		uint64_t generation_{0};
+	};
+
+	// maps the snapshots of a publisher, the values are read in place without being copied
+	class snapshot_subscriber
+	{
+	public:
+		// the publisher must exist already
+		explicit snapshot_subscriber(std::string name);
+		snapshot_subscriber(const snapshot_subscriber&) = delete;
+		snapshot_subscriber(snapshot_subscriber&&) = delete;
+
+		// the generation currently published, an atomic load from the control segment
+		[[nodiscard]] uint64_t get_generation() const noexcept;
+
+		// maps the current generation when it changed since the last call, null until something is published
+		// a snapshot stays valid as long as it is held, even after the publisher moved on or went away
+		[[nodiscard]] std::shared_ptr<const snapshot> get_snapshot();
+
+		snapshot_subscriber& operator=(const snapshot_subscriber&) = delete;
+		snapshot_subscriber& operator=(snapshot_subscriber&&) = delete;
+
+	private:
+		std::string name_;
+		shared_memory control_;
+
+		std::mutex mutex_;
+		uint64_t generation_{0};
+		std::shared_ptr<const snapshot> snapshot_;
+	};
+}
@@ -0,0 +1,735 @@
+﻿#include "pch.h"
+#include "snapshot.h"
+
+#include <bit>
+#include <chrono>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <limits>
+#include <ranges>
+#include <span>
+
+#include "boolean.h"
+#include "enumeration.h"
+#include "exception.h"
+#include "list.h"
+#include "number.h"
+#include "section.h"
+#include "symbol_table.h"
+#include "xcl_string.h"
+
+using namespace std;
+
+// the image is little endian, all records are aligned to 8 bytes and refer to each other by offsets from the start of the image
+namespace xcl::snapshot_format
+{
+	constexpr char magic[4] = { 'X', 'C', 'L', 'B' };
+	constexpr uint32_t version = 1;
+
+	struct text_ref
+	{
+		uint32_t offset;
+		uint32_t length;
+	};
+
+	struct value_record
+	{
+		uint32_t type;
+		uint32_t kind;
+		// the integer, boolean or enumeration index itself,
+		// or the offset of the text, the field values or the list members in the low half and the length or count in the high half
+		int64_t payload;
+	};
+
+	struct type_record
+	{
+		text_ref name;
+		uint32_t kind;
+		// fields of a section or values of an enumeration
+		uint32_t member_count;
+		uint32_t members;
+		uint32_t element_type;
+	};
+
+	struct field_record
+	{
+		text_ref name;
+		uint32_t type;
+		uint32_t padding;
+		value_record default_value;
+	};
+
+	struct required_record
+	{
+		text_ref name;
+		uint32_t type;
+		uint32_t padding;
+	};
+
+	struct data_record
+	{
+		text_ref name;
+		value_record value;
+	};
+
+	struct header
+	{
+		char magic[4];
+		uint32_t version;
+		uint64_t size;
+		uint32_t type_count;
+		uint32_t types;
+		uint32_t required_count;
+		uint32_t requireds;
+		uint32_t data_count;
+		uint32_t data;
+		// open addressing table of data indexes plus one, its size is a power of two
+		uint32_t slot_count;
+		uint32_t slots;
+	};
+
+	// the hash is part of the format, so it must not depend on the standard library
+	constexpr uint64_t hash_name(const std::string_view name) noexcept
+	{
+		uint64_t result = 14695981039346656037ull;
+		for (const auto character : name)
+		{
+			result = (result ^ static_cast<unsigned char>(character)) * 1099511628211ull;
+		}
+		return result;
+	}
+
+	constexpr uint32_t low(const int64_t payload) noexcept { return static_cast<uint32_t>(static_cast<uint64_t>(payload)); }
+	constexpr uint32_t high(const int64_t payload) noexcept { return static_cast<uint32_t>(static_cast<uint64_t>(payload) >> 32); }
+	constexpr int64_t pack(const uint32_t low, const uint32_t high) noexcept { return static_cast<int64_t>(static_cast<uint64_t>(high) << 32 | low); }
+}
+
+using namespace xcl::snapshot_format;
+
+static_assert(std::endian::native == std::endian::little, "snapshot images are little endian");
+
+namespace
+{
+	class image_writer
+	{
+	public:
+		explicit image_writer(const xcl::document& document)
+		{
+			append(header{});
+			collect_types(document);
+		}
+
+		std::vector<char> write(const xcl::document& document)
+		{
+			header result{};
+			memcpy(result.magic, magic, sizeof magic);
+			result.version = version;
+
+			// the values first, since they may refer to types the documents do not define themselves
+			vector<data_record> data;
+			for (const auto& [name, value] : document.get_data())
+			{
+				data.push_back({ add_text(name), write_value(value) });
+			}
+
+			vector<required_record> requireds;
+			document.for_each_required_definition([this, &requireds](const xcl::symbol name, const xcl::types::type& type)
+			{
+				requireds.push_back({ add_text(xcl::symbol_table::get_instance().get_name(name)), type_index(type), 0 });
+			});
+
+			result.type_count = static_cast<uint32_t>(types_.size());
+			result.types = write_types();
+			result.required_count = static_cast<uint32_t>(requireds.size());
+			result.requireds = append_all(requireds);
+			result.data_count = static_cast<uint32_t>(data.size());
+			result.data = append_all(data);
+
+			vector<uint32_t> slots(std::bit_ceil(std::max<size_t>(data.size() * 2, 8)));
+			for (uint32_t index = 0; index < data.size(); ++index)
+			{
+				const auto name = string_view(bytes_.data() + data[index].name.offset, data[index].name.length);
+				auto slot = hash_name(name) & (slots.size() - 1);
+				while (slots[slot] != 0)
+					slot = (slot + 1) & (slots.size() - 1);
+				slots[slot] = index + 1;
+			}
+			result.slot_count = static_cast<uint32_t>(slots.size());
+			result.slots = append_all(slots);
+
+			result.size = bytes_.size();
+			memcpy(bytes_.data(), &result, sizeof result);
+			return std::move(bytes_);
+		}
+
+	private:
+		template <class T>
+		uint32_t append_all(const std::span<const T> records)
+		{
+			// texts are packed, records are aligned to 8 bytes
+			constexpr size_t alignment = is_same_v<T, char> ? 1 : 8;
+			bytes_.resize((bytes_.size() + alignment - 1) & ~(alignment - 1));
+			const auto offset = bytes_.size();
+			if (offset + records.size_bytes() > numeric_limits<uint32_t>::max())
+			{
+				throw xcl::errors::xcl_runtime_error("The document is too large for a snapshot.");
+			}
+			bytes_.resize(offset + records.size_bytes());
+			if (!records.empty())
+				memcpy(bytes_.data() + offset, records.data(), records.size_bytes());
+			return static_cast<uint32_t>(offset);
+		}
+
+		template <class T>
+		uint32_t append_all(const vector<T>& records) { return append_all(std::span<const T>(records)); }
+
+		template <class T>
+		uint32_t append(const T& record) { return append_all(std::span<const T>(&record, 1)); }
+
+		text_ref add_text(const string_view text)
+		{
+			if (const auto existing = texts_.find(string(text)); existing != texts_.end())
+				return existing->second;
+			const auto offset = append_all(std::span<const char>(text.data(), text.size()));
+			const text_ref result{ offset, static_cast<uint32_t>(text.size()) };
+			texts_.emplace(text, result);
+			return result;
+		}
+
+		// the builtin types come first, then the custom types of the document and of its imports
+		void collect_types(const xcl::document& document)
+		{
+			for (const xcl::types::type* builtin : initializer_list<const xcl::types::type*>{ xcl::types::number::get_instance().get(), xcl::types::boolean::get_instance().get(), xcl::types::string::get_instance().get() })
+				(void)type_index(*builtin);
+			for (const auto& type : document.get_types() | views::values)
+				(void)type_index(*type);
+			for (const auto& import : document.get_imports())
+				collect_types(*import);
+		}
+
+		uint32_t type_index(const xcl::types::type& type)
+		{
+			const auto [entry, is_new] = type_indexes_.try_emplace(&type, static_cast<uint32_t>(types_.size()));
+			if (is_new)
+				types_.push_back(&type);
+			return entry->second;
+		}
+
+		uint32_t write_types()
+		{
+			// writing a type may add the types of its fields or elements
+			vector<type_record> records;
+			for (size_t index = 0; index < types_.size(); ++index)
+			{
+				const auto& type = *types_[index];
+				type_record record{ add_text(type.get_name()), xcl::empty_value, 0, 0, 0 };
+				if (const auto section = dynamic_cast<const xcl::types::section*>(&type))
+				{
+					vector<field_record> fields;
+					for (size_t slot = 0; slot < section->get_fields().size(); ++slot)
+					{
+						const auto& field = *section->get_fields()[slot];
+						fields.push_back({ add_text(field.get_name()), type_index(field.get_type()), 0, write_value(field.get_default_value()) });
+					}
+					record.kind = xcl::section_value;
+					record.member_count = static_cast<uint32_t>(fields.size());
+					record.members = append_all(fields);
+				}
+				else if (const auto enumeration = dynamic_cast<const xcl::types::enumeration*>(&type))
+				{
+					vector<text_ref> names;
+					for (const auto& name : enumeration->get_values())
+						names.push_back(add_text(name));
+					record.kind = xcl::enumeration_value;
+					record.member_count = static_cast<uint32_t>(names.size());
+					record.members = append_all(names);
+				}
+				else if (const auto list = dynamic_cast<const xcl::types::list*>(&type))
+				{
+					record.kind = xcl::list_value;
+					record.element_type = type_index(list->get_contained_type());
+				}
+				else if (dynamic_cast<const xcl::types::number*>(&type))
+				{
+					record.kind = xcl::integer_value;
+				}
+				else if (dynamic_cast<const xcl::types::boolean*>(&type))
+				{
+					record.kind = xcl::boolean_value;
+				}
+				else if (dynamic_cast<const xcl::types::string*>(&type))
+				{
+					record.kind = xcl::string_value;
+				}
+				records.push_back(record);
+			}
+			return append_all(records);
+		}
+
+		value_record write_value(const xcl::value& value)
+		{
+			value_record result{ 0, value.get_kind(), 0 };
+			if (value.is_empty())
+				return result;
+
+			result.type = type_index(value.get_type());
+			switch (value.get_kind())
+			{
+			case xcl::integer_value:
+				result.payload = value.as_integer();
+				break;
+			case xcl::boolean_value:
+				result.payload = value.as_boolean();
+				break;
+			case xcl::enumeration_value:
+				result.payload = value.as_enumeration_index();
+				break;
+			case xcl::string_value:
+			{
+				const auto text = add_text(value.as_string());
+				result.payload = pack(text.offset, text.length);
+				break;
+			}
+			case xcl::section_value:
+			{
+				// the fields are stored with their defaults applied, in the order of the type
+				const auto& section = value.as_section();
+				vector<value_record> fields;
+				for (size_t slot = 0; slot < static_cast<const xcl::types::section&>(section.get_type()).get_fields().size(); ++slot)
+					fields.push_back(write_value(section.find_value(slot)));
+				result.payload = pack(append_all(fields), static_cast<uint32_t>(fields.size()));
+				break;
+			}
+			case xcl::list_value:
+			{
+				vector<value_record> members;
+				for (const auto& member : value.as_list().get_values())
+					members.push_back(write_value(member));
+				result.payload = pack(append_all(members), static_cast<uint32_t>(members.size()));
+				break;
+			}
+			case xcl::empty_value:
+				break;
+			}
+			return result;
+		}
+
+		std::vector<char> bytes_;
+		unordered_map<string, text_ref> texts_;
+		vector<const xcl::types::type*> types_;
+		unordered_map<const xcl::types::type*, uint32_t> type_indexes_;
+	};
+}
+
+std::vector<char> xcl::compile_snapshot(const document& document)
+{
+	return image_writer(document).write(document);
+}
+
+void xcl::write_snapshot(const document& document, const std::filesystem::path& path)
+{
+	const auto image = compile_snapshot(document);
+
+	// the image is written next to the target and renamed over it, so a process that has the previous image mapped keeps reading it whole
+	auto temporary = path;
+	temporary += std::format(".{}.tmp", chrono::steady_clock::now().time_since_epoch().count());
+	{
+		ofstream output(temporary, ios::binary | ios::trunc);
+		output.write(image.data(), static_cast<streamsize>(image.size()));
+		output.close();
+		if (!output)
+		{
+			error_code error;
+			filesystem::remove(temporary, error);
+			throw errors::xcl_runtime_error(std::format("The file `{}` could not be written.", path.string()));
+		}
+	}
+
+	error_code error;
+	filesystem::rename(temporary, path, error);
+	if (error)
+	{
+		filesystem::remove(temporary, error);
+		throw errors::xcl_runtime_error(std::format("The file `{}` could not be written.", path.string()));
+	}
+}
+
+xcl::snapshot::snapshot(const std::filesystem::path& path) : file_(std::in_place, path), image_(file_->get_text())
+{
+	validate();
+}
+
+xcl::snapshot::snapshot(const std::string_view image) : image_(image)
+{
+	validate();
+}
+
+void xcl::snapshot::validate() const
+{
+	if (image_.size() < sizeof(header) || memcmp(image_.data(), magic, sizeof magic) != 0 || reinterpret_cast<uintptr_t>(image_.data()) % alignof(header) != 0)
+	{
+		throw errors::xcl_runtime_error("The image is not a compiled snapshot.");
+	}
+
+	const auto& image = at<header>(0);
+	if (image.version != version)
+	{
+		throw errors::xcl_runtime_error(std::format("The snapshot has version {}, while version {} is supported.", image.version, version));
+	}
+
+	const auto check = [](const bool is_valid)
+	{
+		if (!is_valid)
+			throw errors::xcl_runtime_error("The snapshot is damaged.");
+	};
+	check(image.size == image_.size()
+		&& fits(image.types, image.type_count, sizeof(type_record))
+		&& fits(image.requireds, image.required_count, sizeof(required_record))
+		&& fits(image.data, image.data_count, sizeof(data_record))
+		&& fits(image.slots, image.slot_count, sizeof(uint32_t))
+		&& std::has_single_bit(image.slot_count));
+
+	// everything reached from the tables without reading a value is checked, so lookups need no checks of their own
+	for (uint32_t index = 0; index < image.type_count; ++index)
+	{
+		const auto& type = at<type_record>(image.types, index);
+		validate_text(type.name);
+		switch (type.kind)
+		{
+		case section_value:
+			check(fits(type.members, type.member_count, sizeof(field_record)));
+			for (uint32_t slot = 0; slot < type.member_count; ++slot)
+			{
+				const auto& field = at<field_record>(type.members, slot);
+				validate_text(field.name);
+				check(field.type < image.type_count);
+				validate_value(field.default_value);
+			}
+			break;
+		case enumeration_value:
+			check(fits(type.members, type.member_count, sizeof(text_ref)));
+			for (uint32_t member = 0; member < type.member_count; ++member)
+				validate_text(at<text_ref>(type.members, member));
+			break;
+		case list_value:
+			check(type.element_type < image.type_count);
+			break;
+		case integer_value:
+		case boolean_value:
+		case string_value:
+			break;
+		default:
+			check(false);
+		}
+	}
+	for (uint32_t index = 0; index < image.required_count; ++index)
+	{
+		const auto& required = at<required_record>(image.requireds, index);
+		validate_text(required.name);
+		check(required.type < image.type_count);
+	}
+	for (uint32_t index = 0; index < image.data_count; ++index)
+	{
+		const auto& data = at<data_record>(image.data, index);
+		validate_text(data.name);
+		validate_value(data.value);
+	}
+
+	// a probe ends on an empty slot
+	auto has_empty_slot = false;
+	for (uint32_t slot = 0; slot < image.slot_count; ++slot)
+	{
+		const auto index = at<uint32_t>(image.slots, slot);
+		check(index <= image.data_count);
+		has_empty_slot |= index == 0;
+	}
+	check(has_empty_slot);
+}
+
+void xcl::snapshot::validate_text(const text_ref& text) const
+{
+	if (static_cast<uint64_t>(text.offset) + text.length > image_.size())
+	{
+		throw errors::xcl_runtime_error("The snapshot is damaged.");
+	}
+}
+
+void xcl::snapshot::validate_value(const value_record& value) const
+{
+	// the texts and members of the value are checked when they are read
+	if (value.kind > list_value || (value.kind != empty_value && value.type >= at<header>(0).type_count))
+	{
+		throw errors::xcl_runtime_error("The snapshot is damaged.");
+	}
+}
+
+bool xcl::snapshot::fits(const uint64_t offset, const uint64_t count, const uint64_t size) const noexcept
+{
+	return offset % 8 == 0 && offset <= image_.size() && count <= (image_.size() - offset) / size;
+}
+
+std::string_view xcl::snapshot::read_text(const uint32_t offset, const uint32_t length) const
+{
+	validate_text({ offset, length });
+	return get_text(offset, length);
+}
+
+const xcl::snapshot_format::value_record& xcl::snapshot::read_member(const value_record& value, const size_t index) const
+{
+	if (index >= high(value.payload) || !fits(low(value.payload), high(value.payload), sizeof(value_record)))
+	{
+		throw errors::xcl_runtime_error("The snapshot is damaged.");
+	}
+	const auto& member = at<value_record>(low(value.payload), index);
+	validate_value(member);
+	return member;
+}
+
+std::optional<xcl::snapshot_value> xcl::snapshot::find_data(const std::string_view name) const noexcept
+{
+	const auto& image = at<header>(0);
+	const auto mask = image.slot_count - 1;
+	for (auto slot = static_cast<uint32_t>(hash_name(name) & mask); ; slot = (slot + 1) & mask)
+	{
+		const auto index = at<uint32_t>(image.slots, slot);
+		if (index == 0)
+			return nullopt;
+		if (const auto& record = at<data_record>(image.data, index - 1); get_text(record.name.offset, record.name.length) == name)
+			return snapshot_value(*this, record.value);
+	}
+}
+
+size_t xcl::snapshot::get_data_count() const noexcept
+{
+	return at<header>(0).data_count;
+}
+
+std::pair<std::string_view, xcl::snapshot_value> xcl::snapshot::get_data(const size_t index) const
+{
+	if (index >= get_data_count())
+	{
+		throw errors::xcl_runtime_error(std::format("The index {} is out of the {} values of the snapshot.", index, get_data_count()));
+	}
+	const auto& record = at<data_record>(at<header>(0).data, index);
+	return { get_text(record.name.offset, record.name.length), snapshot_value(*this, record.value) };
+}
+
+std::optional<xcl::snapshot_type> xcl::snapshot::find_type(const std::string_view name) const noexcept
+{
+	for (uint32_t index = 0; index < at<header>(0).type_count; ++index)
+	{
+		if (const auto type = get_type(index); type.get_name() == name)
+			return type;
+	}
+	return nullopt;
+}
+
+std::vector<std::pair<std::string_view, std::string_view>> xcl::snapshot::get_required_definitions() const
+{
+	vector<pair<string_view, string_view>> result;
+	const auto& image = at<header>(0);
+	for (uint32_t index = 0; index < image.required_count; ++index)
+	{
+		const auto& record = at<required_record>(image.requireds, index);
+		result.emplace_back(get_text(record.name.offset, record.name.length), get_type(record.type).get_name());
+	}
+	return result;
+}
+
+xcl::snapshot_type xcl::snapshot::get_type(const uint32_t index) const
+{
+	if (index >= at<header>(0).type_count)
+	{
+		throw errors::xcl_runtime_error("The snapshot is damaged.");
+	}
+	return { *this, at<type_record>(at<header>(0).types, index) };
+}
+
+std::string_view xcl::snapshot_type::get_name() const noexcept
+{
+	return image_->get_text(record_->name.offset, record_->name.length);
+}
+
+xcl::value_kind xcl::snapshot_type::get_kind() const noexcept
+{
+	return static_cast<value_kind>(record_->kind);
+}
+
+size_t xcl::snapshot_type::get_member_count() const noexcept
+{
+	return record_->member_count;
+}
+
+std::string_view xcl::snapshot_type::get_member_name(const size_t index) const
+{
+	check_member(index);
+	if (get_kind() == enumeration_value)
+	{
+		const auto& name = image_->at<text_ref>(record_->members, index);
+		return image_->get_text(name.offset, name.length);
+	}
+	expect_kind(section_value);
+	const auto& name = image_->at<field_record>(record_->members, index).name;
+	return image_->get_text(name.offset, name.length);
+}
+
+xcl::snapshot_type xcl::snapshot_type::get_field_type(const size_t index) const
+{
+	expect_kind(section_value);
+	check_member(index);
+	return image_->get_type(image_->at<field_record>(record_->members, index).type);
+}
+
+xcl::snapshot_value xcl::snapshot_type::get_field_default(const size_t index) const
+{
+	expect_kind(section_value);
+	check_member(index);
+	return { *image_, image_->at<field_record>(record_->members, index).default_value };
+}
+
+xcl::snapshot_type xcl::snapshot_type::get_element_type() const
+{
+	expect_kind(list_value);
+	return image_->get_type(record_->element_type);
+}
+
+void xcl::snapshot_type::check_member(const size_t index) const
+{
+	if (index >= get_member_count())
+	{
+		throw errors::xcl_runtime_error(std::format("The index {} is out of the {} members of the type `{}`.", index, get_member_count(), get_name()));
+	}
+}
+
+void xcl::snapshot_type::expect_kind(const value_kind kind) const
+{
+	if (get_kind() != kind)
+	{
+		throw errors::xcl_runtime_error(std::format("The type `{}` does not have members of this kind.", get_name()));
+	}
+}
+
+xcl::value_kind xcl::snapshot_value::get_kind() const noexcept
+{
+	return static_cast<value_kind>(record_->kind);
+}
+
+xcl::snapshot_type xcl::snapshot_value::get_type() const
+{
+	if (is_empty())
+	{
+		throw errors::xcl_runtime_error("An empty value does not have a type.");
+	}
+	return image_->get_type(record_->type);
+}
+
+long xcl::snapshot_value::as_integer() const
+{
+	expect_kind(integer_value);
+	return static_cast<long>(record_->payload);
+}
+
+bool xcl::snapshot_value::as_boolean() const
+{
+	expect_kind(boolean_value);
+	return record_->payload != 0;
+}
+
+int xcl::snapshot_value::as_enumeration_index() const
+{
+	expect_kind(enumeration_value);
+	return static_cast<int>(record_->payload);
+}
+
+std::string_view xcl::snapshot_value::as_enumeration_name() const
+{
+	return get_type().get_member_name(static_cast<size_t>(as_enumeration_index()));
+}
+
+std::string_view xcl::snapshot_value::as_string() const
+{
+	expect_kind(string_value);
+	return image_->read_text(low(record_->payload), high(record_->payload));
+}
+
+std::optional<xcl::snapshot_value> xcl::snapshot_value::find_field(const std::string_view name) const
+{
+	expect_kind(section_value);
+	const auto type = get_type();
+	for (size_t slot = 0; slot < type.get_member_count(); ++slot)
+	{
+		if (type.get_member_name(slot) == name)
+			return snapshot_value(*image_, image_->read_member(*record_, slot));
+	}
+	return nullopt;
+}
+
+xcl::snapshot_value xcl::snapshot_value::get_field(const std::string_view name) const
+{
+	if (const auto field = find_field(name))
+		return *field;
+	throw errors::member_not_found_error(std::string(name), std::string(get_type().get_name()));
+}
+
+size_t xcl::snapshot_value::size() const
+{
+	expect_kind(list_value);
+	return high(record_->payload);
+}
+
+xcl::snapshot_value xcl::snapshot_value::operator[](const size_t index) const
+{
+	if (index >= size())
+	{
+		throw errors::xcl_runtime_error(std::format("The index {} is out of the {} members of the list.", index, size()));
+	}
+	return { *image_, image_->read_member(*record_, index) };
+}
+
+std::string xcl::snapshot_value::to_string() const
+{
+	switch (get_kind())
+	{
+	case integer_value:
+		return std::to_string(as_integer());
+	case boolean_value:
+		return as_boolean() ? "True" : "False";
+	case enumeration_value:
+		return std::string(as_enumeration_name());
+	case string_value:
+		return std::string(as_string());
+	case section_value:
+	{
+		std::string result{"{ "};
+		const auto type = get_type();
+		for (size_t slot = 0; slot < type.get_member_count(); ++slot)
+		{
+			result += std::format("{} = {}, ", type.get_member_name(slot), snapshot_value(*image_, image_->read_member(*record_, slot)).to_string());
+		}
+		result += "}";
+		return result;
+	}
+	case list_value:
+	{
+		std::string result{"[ "};
+		for (size_t index = 0; index < size(); ++index)
+		{
+			result += (*this)[index].to_string() + ", ";
+		}
+		result += " ]";
+		return result;
+	}
+	case empty_value:
+		break;
+	}
+	return {};
+}
+
+void xcl::snapshot_value::expect_kind(const value_kind kind) const
+{
+	if (get_kind() != kind)
+	{
+		throw errors::xcl_runtime_error(std::format("A value of type `{}` can not be read as another kind of value.", get_kind() != empty_value ? image_->get_type(record_->type).get_name() : ""));
+	}
+}
@@ -0,0 +1,153 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "document.h"
+#include "mapped_file.h"
+#include "value.h"
+
+namespace xcl
+{
+	class snapshot;
+	class snapshot_value;
+
+	namespace snapshot_format
+	{
+		struct text_ref;
+		struct type_record;
+		struct value_record;
+	}
+
+	// serializes the document with everything it resolves through its imports, the custom types, the required definitions and the values,
+	// into an image that refers to its parts by offsets, so it can be used wherever it is mapped
+	[[nodiscard]] std::vector<char> compile_snapshot(const document& document);
+
+	// replaces the file as a whole, snapshots mapped from the previous file keep reading it
+	void write_snapshot(const document& document, const std::filesystem::path& path);
+
+	// views into a snapshot are valid as long as the snapshot is alive
+	class snapshot_type
+	{
+	public:
+		[[nodiscard]] std::string_view get_name() const noexcept;
+
+		// the kind of the values of the type
+		[[nodiscard]] value_kind get_kind() const noexcept;
+
+		// fields of a section and values of an enumeration
+		[[nodiscard]] size_t get_member_count() const noexcept;
+		[[nodiscard]] std::string_view get_member_name(size_t index) const;
+
+		[[nodiscard]] snapshot_type get_field_type(size_t index) const;
+		// empty for a required field
+		[[nodiscard]] snapshot_value get_field_default(size_t index) const;
+
+		[[nodiscard]] snapshot_type get_element_type() const;
+
+	private:
+		friend class snapshot;
+		friend class snapshot_value;
+
+		snapshot_type(const snapshot& image, const snapshot_format::type_record& record) noexcept : image_(&image), record_(&record) {}
+
+		void expect_kind(value_kind kind) const;
+		void check_member(size_t index) const;
+
+		const snapshot* image_;
+		const snapshot_format::type_record* record_;
+	};
+
+	class snapshot_value
+	{
+	public:
+		[[nodiscard]] value_kind get_kind() const noexcept;
+		[[nodiscard]] bool is_empty() const noexcept { return get_kind() == empty_value; }
+
+		[[nodiscard]] snapshot_type get_type() const;
+
+		[[nodiscard]] long as_integer() const;
+		[[nodiscard]] bool as_boolean() const;
+		[[nodiscard]] int as_enumeration_index() const;
+		[[nodiscard]] std::string_view as_enumeration_name() const;
+		[[nodiscard]] std::string_view as_string() const;
+
+		// fields of a section, with their default when they were not set
+		[[nodiscard]] std::optional<snapshot_value> find_field(std::string_view name) const;
+		[[nodiscard]] snapshot_value get_field(std::string_view name) const;
+
+		// members of a list
+		[[nodiscard]] size_t size() const;
+		[[nodiscard]] snapshot_value operator[](size_t index) const;
+
+		// the same text as the value it was compiled from
+		[[nodiscard]] std::string to_string() const;
+
+	private:
+		friend class snapshot;
+		friend class snapshot_type;
+
+		snapshot_value(const snapshot& image, const snapshot_format::value_record& record) noexcept : image_(&image), record_(&record) {}
+
+		void expect_kind(value_kind kind) const;
+
+		const snapshot* image_;
+		const snapshot_format::value_record* record_;
+	};
+
+	// a compiled document served directly from its image, nothing is parsed or rebuilt when it is loaded
+	class snapshot
+	{
+	public:
+		// the file is mapped, the header and the tables of types, required definitions, data and slots are checked,
+		// the texts and members of a value only when they are read, so loading costs no walk over the values
+		explicit snapshot(const std::filesystem::path& path);
+
+		// the image is not copied and must outlive the snapshot
+		explicit snapshot(std::string_view image);
+
+		snapshot(const snapshot&) = delete;
+		snapshot& operator=(const snapshot&) = delete;
+
+		[[nodiscard]] std::optional<snapshot_value> find_data(std::string_view name) const noexcept;
+
+		// values in the order they were defined
+		[[nodiscard]] size_t get_data_count() const noexcept;
+		[[nodiscard]] std::pair<std::string_view, snapshot_value> get_data(size_t index) const;
+
+		[[nodiscard]] std::optional<snapshot_type> find_type(std::string_view name) const noexcept;
+
+		// name and type name of every required definition
+		[[nodiscard]] std::vector<std::pair<std::string_view, std::string_view>> get_required_definitions() const;
+
+	private:
+		friend class snapshot_type;
+		friend class snapshot_value;
+
+		void validate() const;
+		void validate_text(const snapshot_format::text_ref& text) const;
+		void validate_value(const snapshot_format::value_record& value) const;
+		[[nodiscard]] bool fits(uint64_t offset, uint64_t count, uint64_t size) const noexcept;
+
+		template <class T>
+		[[nodiscard]] const T& at(const uint32_t offset, const size_t index = 0) const noexcept
+		{
+			return reinterpret_cast<const T*>(image_.data() + offset)[index];
+		}
+
+		// for the texts checked by validate
+		[[nodiscard]] std::string_view get_text(uint32_t offset, uint32_t length) const noexcept { return { image_.data() + offset, length }; }
+		// for the texts and members of values, which are checked as they are read
+		[[nodiscard]] std::string_view read_text(uint32_t offset, uint32_t length) const;
+		[[nodiscard]] const snapshot_format::value_record& read_member(const snapshot_format::value_record& value, size_t index) const;
+		[[nodiscard]] snapshot_type get_type(uint32_t index) const;
+
+		std::optional<mapped_file> file_;
+		std::string_view image_;
+	};
+}
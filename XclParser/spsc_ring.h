@@ -0,0 +1,69 @@
+﻿#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace xcl
+{
+	// bounded queue between one producer and one consumer thread, a full ring blocks the producer until the consumer catches up
+	template <class T>
+	class spsc_ring
+	{
+	public:
+		explicit spsc_ring(const size_t capacity) : items_(capacity) {}
+
+		spsc_ring(const spsc_ring&) = delete;
+		spsc_ring& operator=(const spsc_ring&) = delete;
+
+		// returns false when the ring was closed, the item is dropped then
+		bool push(T item)
+		{
+			std::unique_lock lock(mutex_);
+			not_full_.wait(lock, [this] { return count_ < items_.size() || closed_; });
+			if (closed_)
+				return false;
+			items_[(head_ + count_) % items_.size()] = std::move(item);
+			++count_;
+			lock.unlock();
+			not_empty_.notify_one();
+			return true;
+		}
+
+		// the items pushed before closing are still popped, nullopt once the ring is closed and empty
+		std::optional<T> pop()
+		{
+			std::unique_lock lock(mutex_);
+			not_empty_.wait(lock, [this] { return count_ > 0 || closed_; });
+			if (count_ == 0)
+				return std::nullopt;
+			std::optional<T> result(std::move(items_[head_]));
+			head_ = (head_ + 1) % items_.size();
+			--count_;
+			lock.unlock();
+			not_full_.notify_one();
+			return result;
+		}
+
+		// the producer closes at the end of its input, the consumer to cancel the producer
+		void close()
+		{
+			{
+				std::lock_guard lock(mutex_);
+				closed_ = true;
+			}
+			not_full_.notify_all();
+			not_empty_.notify_all();
+		}
+
+	private:
+		std::vector<T> items_;
+		size_t head_{0};
+		size_t count_{0};
+		bool closed_{false};
+		std::mutex mutex_;
+		std::condition_variable not_full_;
+		std::condition_variable not_empty_;
+	};
+}
@@ -0,0 +1,123 @@
+﻿#include "pch.h"
+#include "statement_scanner.h"
+
+#include "exception.h"
+#include "token.h"
+#include "token_stream.h"
+
+using namespace std;
+
+std::optional<std::vector<xcl::parser::statement_run>> xcl::parser::scan_statement_runs(const std::string_view source)
+{
+	vector<statement_run> result;
+	// the tokens of the current statement outside of braces, new lines excluded
+	size_t statement_tokens = 0;
+	auto first_keyword = not_keyword;
+	// the last two of them
+	auto previous = new_line;
+	auto before_previous = new_line;
+	auto is_complete = true;
+
+	for (size_t position = 0;;)
+	{
+		token current{new_line, {}};
+		try
+		{
+			if (!lex_token(source, position, true, current))
+				break;
+		}
+		catch (const errors::xcl_exception&)
+		{
+			return nullopt;
+		}
+
+		switch (current.get_type())
+		{
+		case new_line:
+			// a new line ends an import, a required declaration and a value assigned with =, other statements may span lines
+			if (!is_complete && (before_previous == equals
+				|| (first_keyword == import_keyword && statement_tokens == 2)
+				|| (first_keyword == required_keyword && statement_tokens == 3)))
+			{
+				is_complete = true;
+			}
+			continue;
+		case string_literal:
+			if (current.get_text().size() < 2 || current.get_text().back() != '"')
+				return nullopt;
+			break;
+		case left_brace:
+			// the braces of a statement close it, their content is skipped without a lexer pass
+			for (size_t depth = 1; depth != 0; ++position)
+			{
+				position = source.find_first_of("{}\"", position);
+				if (position == string_view::npos)
+					return nullopt;
+				if (source[position] == '"')
+				{
+					position = source.find('"', position + 1);
+					if (position == string_view::npos)
+						return nullopt;
+				}
+				else
+				{
+					depth += source[position] == '{' ? 1 : -1;
+				}
+			}
+			if (is_complete)
+				return nullopt;
+			is_complete = true;
+			continue;
+		case right_brace:
+			return nullopt;
+		default:
+			break;
+		}
+
+		if (is_complete)
+		{
+			// a statement starts with a keyword or a name, the first word tells declarations from data definitions
+			if (current.get_type() != keyword && current.get_type() != identifier)
+				return nullopt;
+			const auto begin = static_cast<size_t>(current.get_text().data() - source.data());
+			const auto is_declaration = current.get_type() == keyword;
+			if (result.empty() || result.back().is_declaration != is_declaration)
+			{
+				if (!result.empty())
+					result.back().end = begin;
+				result.push_back({ begin, source.size(), is_declaration, {} });
+			}
+			result.back().statements.push_back(begin);
+			statement_tokens = 0;
+			first_keyword = current.get_keyword();
+			previous = new_line;
+			is_complete = false;
+		}
+		++statement_tokens;
+		before_previous = previous;
+		previous = current.get_type();
+	}
+
+	if (!is_complete)
+		return nullopt;
+	if (result.empty())
+		return result;
+	// whatever precedes the first statement is parsed with it
+	result.front().begin = 0;
+	return result;
+}
+
+std::vector<xcl::parser::definition_index::definition> xcl::parser::list_definitions(const std::vector<statement_run>& runs, const size_t offset)
+{
+	vector<definition_index::definition> result;
+	for (const auto& run : runs)
+	{
+		for (size_t index = 0; index < run.statements.size(); ++index)
+		{
+			const auto begin = index == 0 ? run.begin : run.statements[index];
+			const auto end = index + 1 == run.statements.size() ? run.end : run.statements[index + 1];
+			result.push_back({ offset + begin, offset + end, run.is_declaration });
+		}
+	}
+	return result;
+}
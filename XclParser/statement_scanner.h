@@ -0,0 +1,50 @@
+﻿#pragma once
+
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace xcl::parser
+{
+	// consecutive top-level statements of the same kind
+	struct statement_run
+	{
+		size_t begin;
+		size_t end;
+		// imports, type and required definitions, everything after them depends on them
+		bool is_declaration;
+		// offsets of the statements in the run, the first one is begin
+		std::vector<size_t> statements;
+	};
+
+	// the top-level statements of a parsed source, kept to reparse only the statements touched by an edit
+	struct definition_index
+	{
+		struct definition
+		{
+			size_t begin;
+			size_t end;
+			bool is_declaration;
+		};
+
+		std::vector<definition> definitions;
+		// false when the data definitions do not map one to one to the values of the document, a name defined twice for one
+		bool is_incremental{false};
+	};
+
+	// a replaced byte range, offsets are in the source before the edit
+	struct text_edit
+	{
+		size_t offset;
+		size_t removed;
+		size_t inserted;
+	};
+
+	// finds the top-level statements with the lexer, a statement only ends where the grammar completes it:
+	// after its closing brace, or after the new line that ends an import, a required declaration or a value assigned with =
+	// the content of braces is skipped without a lexer pass, nullopt when the source does not split into whole statements
+	[[nodiscard]] std::optional<std::vector<statement_run>> scan_statement_runs(std::string_view source);
+
+	// one definition per statement of the runs, moved by offset
+	[[nodiscard]] std::vector<definition_index::definition> list_definitions(const std::vector<statement_run>& runs, size_t offset);
+}
@@ -6,24 +6,24 @@
 
 std::shared_ptr<xcl::types::string> xcl::types::string::instance_ = std::make_shared<xcl::types::string>();
 
-std::unique_ptr<xcl::objects::string> xcl::types::string::activate(const std::string& value) const noexcept
+xcl::value xcl::types::string::activate(const std::string_view value, std::pmr::memory_resource& arena) const
 {
-	return std::make_unique<xcl::objects::string>(*this, value);
+	return xcl::value(*this, value).clone(arena);
 }
 
-std::unique_ptr<xcl::objects::object> xcl::types::string::activate(const xcl::parser::token& token) const
+xcl::value xcl::types::string::activate(const xcl::parser::token& token, std::pmr::memory_resource& arena) const
 {
 	if (token.get_type() != parser::string_literal)
 		throw errors::unexpected_token_error(token);
-	return activate(token.parse_string_literal());
+	return { *this, token.parse_string_literal(arena) };
 }
 
-std::unique_ptr<xcl::objects::object> xcl::objects::string::clone() const
+xcl::objects::object* xcl::objects::string::clone(std::pmr::memory_resource& arena) const
 {
-	return std::make_unique<xcl::objects::string>(*this);
+	return allocate_object<xcl::objects::string>(arena, *this, arena);
 }
 
 std::string xcl::objects::string::to_string() const
 {
-	return value_;
+	return std::string(value_);
 }
@@ -0,0 +1,131 @@
+﻿#include "pch.h"
+#include "symbol_table.h"
+
+#include <functional>
+#include <stdexcept>
+
+#include "exception.h"
+
+xcl::symbol_table::index::index(const size_t capacity) : mask(capacity - 1), entries(std::make_unique<std::atomic<uint64_t>[]>(capacity))
+{
+}
+
+xcl::symbol_table::symbol_table()
+{
+	indexes_.push_back(std::make_unique<index>(initial_capacity));
+	index_.store(indexes_.back().get(), std::memory_order_release);
+
+	// no_symbol is reserved for tokens that are not identifiers
+	blocks_[0].store(new std::string[names_per_block], std::memory_order_release);
+	count_.store(1, std::memory_order_release);
+}
+
+xcl::symbol_table::~symbol_table()
+{
+	for (auto& block : blocks_)
+	{
+		delete[] block.load(std::memory_order_relaxed);
+	}
+}
+
+xcl::symbol xcl::symbol_table::intern(const std::string_view name)
+{
+	const auto hash = hash_name(name);
+	if (const auto existing = find(*index_.load(std::memory_order_acquire), name, hash))
+	{
+		return *existing;
+	}
+
+	std::lock_guard lock(mutex_);
+	auto& current = *index_.load(std::memory_order_relaxed);
+	if (const auto existing = find(current, name, hash))
+	{
+		return *existing;
+	}
+	const auto id = count_.load(std::memory_order_relaxed);
+	if (id > max_symbol)
+	{
+		throw errors::xcl_runtime_error(std::format("Too many distinct identifiers, `{}` can not be added.", name));
+	}
+
+	auto& block = blocks_[id / names_per_block];
+	if (block.load(std::memory_order_relaxed) == nullptr)
+	{
+		block.store(new std::string[names_per_block], std::memory_order_release);
+	}
+	block.load(std::memory_order_relaxed)[id % names_per_block] = name;
+	count_.store(id + 1, std::memory_order_release);
+
+	// the load factor stays below one half, so a probe always ends on an empty entry
+	if (2 * (static_cast<size_t>(id) + 1) <= current.mask + 1)
+	{
+		insert(current, hash, id);
+		return id;
+	}
+	auto grown = std::make_unique<index>(2 * (current.mask + 1));
+	for (symbol existing = 1; existing <= id; ++existing)
+	{
+		insert(*grown, hash_name(name_at(existing)), existing);
+	}
+	index_.store(grown.get(), std::memory_order_release);
+	indexes_.push_back(std::move(grown));
+	return id;
+}
+
+std::optional<xcl::symbol> xcl::symbol_table::find(const std::string_view name) const noexcept
+{
+	return find(*index_.load(std::memory_order_acquire), name, hash_name(name));
+}
+
+std::string_view xcl::symbol_table::get_name(const symbol id) const
+{
+	if (id >= count_.load(std::memory_order_acquire))
+	{
+		throw std::out_of_range("The symbol is not interned.");
+	}
+	return name_at(id);
+}
+
+xcl::symbol_table& xcl::symbol_table::get_instance()
+{
+	// a function local static, so it is constructed before its first use
+	static symbol_table instance;
+	return instance;
+}
+
+uint32_t xcl::symbol_table::hash_name(const std::string_view name) noexcept
+{
+	return static_cast<uint32_t>(std::hash<std::string_view>{}(name));
+}
+
+std::optional<xcl::symbol> xcl::symbol_table::find(const index& index, const std::string_view name, const uint32_t hash) const noexcept
+{
+	for (auto slot = hash & index.mask;; slot = (slot + 1) & index.mask)
+	{
+		// the entry is stored after the name, so a symbol read here has its name in place
+		const auto entry = index.entries[slot].load(std::memory_order_acquire);
+		if (entry == 0)
+		{
+			return std::nullopt;
+		}
+		if (const auto id = static_cast<symbol>(entry); entry >> 32 == hash && name_at(id) == name)
+		{
+			return id;
+		}
+	}
+}
+
+const std::string& xcl::symbol_table::name_at(const symbol id) const noexcept
+{
+	return blocks_[id / names_per_block].load(std::memory_order_acquire)[id % names_per_block];
+}
+
+void xcl::symbol_table::insert(index& index, const uint32_t hash, const symbol id) noexcept
+{
+	auto slot = hash & index.mask;
+	while (index.entries[slot].load(std::memory_order_relaxed) != 0)
+	{
+		slot = (slot + 1) & index.mask;
+	}
+	index.entries[slot].store(static_cast<uint64_t>(hash) << 32 | id, std::memory_order_release);
+}
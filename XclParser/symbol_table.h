@@ -0,0 +1,71 @@
+﻿#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace xcl
+{
+	// dense id of an interned identifier, equal names always have the same id
+	typedef uint32_t symbol;
+
+	constexpr symbol no_symbol = 0;
+
+	// process wide table of identifiers, shared by every parser and document so their symbols compare directly
+	// symbols are never released: the table lives until the process exits and holds every distinct identifier lexed so far,
+	// type, field, enumerator and definition names, but no values, so it grows with the vocabulary of the parsed files rather than with their size
+	// at most max_symbol identifiers fit, interning a new one past that throws, while the identifiers already interned keep working
+	// an identifier that is already interned is found without taking a lock, only adding a new one is serialized
+	class symbol_table
+	{
+	public:
+		// tokens keep the symbol in 24 bits
+		static constexpr symbol max_symbol = (1 << 24) - 1;
+
+		symbol_table(const symbol_table&) = delete;
+		symbol_table& operator=(const symbol_table&) = delete;
+		~symbol_table();
+
+		[[nodiscard]] symbol intern(std::string_view name);
+
+		[[nodiscard]] std::optional<symbol> find(std::string_view name) const noexcept;
+
+		[[nodiscard]] std::string_view get_name(symbol id) const;
+
+		[[nodiscard]] static symbol_table& get_instance();
+
+	private:
+		// open addressing, an entry holds the hash of the name in its upper half and the symbol in its lower half, zero when empty
+		struct index
+		{
+			explicit index(size_t capacity);
+
+			size_t mask;
+			std::unique_ptr<std::atomic<uint64_t>[]> entries;
+		};
+
+		static constexpr size_t names_per_block = 4096;
+		static constexpr size_t initial_capacity = 1024;
+
+		symbol_table();
+
+		[[nodiscard]] static uint32_t hash_name(std::string_view name) noexcept;
+		[[nodiscard]] std::optional<symbol> find(const index& index, std::string_view name, uint32_t hash) const noexcept;
+		[[nodiscard]] const std::string& name_at(symbol id) const noexcept;
+		static void insert(index& index, uint32_t hash, symbol id) noexcept;
+
+		std::mutex mutex_;
+		std::atomic<index*> index_;
+		// an index is only replaced by a larger one, the old ones are kept since readers may still probe them
+		std::vector<std::unique_ptr<index>> indexes_;
+		// the names are stored in blocks that never move, so a reader reaches a name without the lock
+		std::array<std::atomic<std::string*>, (max_symbol + 1) / names_per_block> blocks_{};
+		std::atomic<symbol> count_{0};
+	};
+}
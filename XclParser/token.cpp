@@ -1,6 +1,10 @@
 ﻿#include "pch.h"
 
 #include "token.h"
+
+#include <algorithm>
+#include <cstring>
+
 #include "exception.h"
 
 std::string xcl::parser::token::parse_string_literal() const
@@ -10,5 +14,32 @@ std::string xcl::parser::token::parse_string_literal() const
 		throw xcl::errors::unexpected_token_error(*this);
 	}
 	// TODO: add support for escaping
-	return text_.substr(1, text_.size() - 2);
+	return std::string(get_text().substr(1, length_ - 2));
+}
+
+std::string_view xcl::parser::token::parse_string_literal(std::pmr::memory_resource& arena) const
+{
+	if (type_ != string_literal)
+	{
+		throw xcl::errors::unexpected_token_error(*this);
+	}
+	const auto text = get_text().substr(1, length_ - 2);
+	const auto result = static_cast<char*>(arena.allocate(text.size(), alignof(char)));
+	std::memcpy(result, text.data(), text.size());
+	return { result, text.size() };
+}
+
+void xcl::parser::line_index::add_text(const std::string_view text)
+{
+	for (auto position = text.find('\n'); position != std::string_view::npos; position = text.find('\n', position + 1))
+	{
+		line_starts_.push_back(size_ + position + 1);
+	}
+	size_ += text.size();
+}
+
+xcl::parser::text_location xcl::parser::line_index::locate(const size_t offset) const
+{
+	const auto line = std::ranges::upper_bound(line_starts_, offset) - 1;
+	return { static_cast<int>(line - line_starts_.begin()) + 1, static_cast<int>(offset - *line) + 1 };
 }
@@ -1,35 +1,92 @@
 ﻿#pragma once
 
+#include <cstdint>
+#include <memory_resource>
 #include <string>
+#include <string_view>
+#include <vector>
+
+#include "symbol_table.h"
 
 namespace xcl::parser
 {
-	enum token_type
+	enum token_type : unsigned char
 	{
-		whitespace,
 		new_line,
 		keyword,
 		string_literal,
 		number_literal,
 		identifier,
-		operator_symbol,
+		left_brace,
+		right_brace,
+		equals,
+		comma,
+	};
+
+	enum keyword_kind : unsigned char
+	{
+		not_keyword,
+		import_keyword,
+		section_keyword,
+		default_keyword,
+		required_keyword,
+		enum_keyword,
+		list_keyword,
 	};
 	
 	class token
 	{
 	public:
-		token(const token_type type, const int line, const int column, std::string text) : type_(type), line_(line), column_(column), text_(std::move(text)) {}
+		token(const token_type type, const std::string_view text, const keyword_kind keyword = not_keyword) :
+			text_(text.data()), length_(static_cast<uint32_t>(text.size())), type_(type), tag_(keyword) {}
+		// identifiers carry the symbol they were interned to
+		token(const std::string_view text, const xcl::symbol symbol) :
+			text_(text.data()), length_(static_cast<uint32_t>(text.size())), type_(identifier), tag_(symbol) {}
 
-		[[nodiscard]] token_type get_type() const noexcept { return type_; }
-		[[nodiscard]] int get_line() const noexcept { return line_; }
-		[[nodiscard]] int get_column() const noexcept { return column_; }
-		[[nodiscard]] const std::string& get_text() const noexcept { return text_; }
+		[[nodiscard]] token_type get_type() const noexcept { return static_cast<token_type>(type_); }
+		[[nodiscard]] keyword_kind get_keyword() const noexcept { return type_ == keyword ? static_cast<keyword_kind>(tag_) : not_keyword; }
+		[[nodiscard]] xcl::symbol get_symbol() const noexcept { return type_ == identifier ? tag_ : xcl::no_symbol; }
+		[[nodiscard]] std::string_view get_text() const noexcept { return { text_, length_ }; }
+
+		// the same token with its text moved to another copy of the source
+		[[nodiscard]] token with_text(const std::string_view text) const noexcept
+		{
+			auto result = *this;
+			result.text_ = text.data();
+			return result;
+		}
 		[[nodiscard]] std::string parse_string_literal() const;
+		// the text is copied into the arena
+		[[nodiscard]] std::string_view parse_string_literal(std::pmr::memory_resource& arena) const;
+
+	private:
+		// points into the tokenized source, the source must outlive the token
+		const char* text_;
+		uint32_t length_;
+		uint32_t type_ : 8;
+		// keyword kind of keywords and symbol of identifiers
+		uint32_t tag_ : 24;
+	};
+
+	static_assert(sizeof(token) <= 16);
+
+	struct text_location
+	{
+		int line;
+		int column;
+	};
+
+	// offsets where the lines of a source start, so line and column are only computed when they are needed
+	class line_index
+	{
+	public:
+		// records the lines of the next part of the source
+		void add_text(std::string_view text);
+
+		[[nodiscard]] text_location locate(size_t offset) const;
 
 	private:
-		token_type type_;
-		int line_;
-		int column_;
-		std::string text_;
+		std::vector<size_t> line_starts_{0};
+		size_t size_{0};
 	};
 }
@@ -0,0 +1,431 @@
+﻿#include "pch.h"
+
+#include "token_stream.h"
+
+#include <array>
+#include <algorithm>
+
+#include "exception.h"
+
+using namespace std;
+using namespace xcl::parser;
+
+// in the order of keyword_kind
+constexpr string_view keywords[] = {
+	"import",
+	"section",
+	"default",
+	"required",
+	"enum",
+	"list",
+};
+
+
+enum char_class : unsigned char
+{
+	invalid_char = 0,
+	whitespace_char = 1 << 0,
+	new_line_char = 1 << 1,
+	letter_char = 1 << 2,
+	digit_char = 1 << 3,
+	string_char = 1 << 4,
+	punctuation_char = 1 << 5,
+};
+
+// lookup table from every byte to its class, so the tokenizer classifies a character with a single load
+constexpr auto char_classes = []
+{
+	array<unsigned char, 256> result{};
+
+	result[' '] = result['\t'] = result['\r'] = whitespace_char;
+	result['\n'] = new_line_char;
+
+	for (char c = 'a'; c <= 'z'; c++)
+		result[c] = letter_char;
+
+	for (char c = 'A'; c <= 'Z'; c++)
+		result[c] = letter_char;
+
+	for (char c = '0'; c <= '9'; c++)
+		result[c] = digit_char;
+
+	result['\"'] = string_char;
+
+	result['{'] = result['}'] = result['='] = result[','] = punctuation_char;
+
+	return result;
+}();
+
+inline unsigned char char_class_of(const char c) noexcept
+{
+	return char_classes[static_cast<unsigned char>(c)];
+}
+
+// the punctuation characters are {, }, = and ,
+constexpr token_type punctuation_type(const char c) noexcept
+{
+	switch (c)
+	{
+	case '{':
+		return left_brace;
+	case '}':
+		return right_brace;
+	case '=':
+		return equals;
+	default:
+		return comma;
+	}
+}
+
+// returns the position of the first character after the run of characters matching any of the classes in the mask
+inline size_t scan_run(const string_view input, size_t position, const unsigned char mask) noexcept
+{
+	while (position < input.size() && (char_class_of(input[position]) & mask) != 0) { ++position; }
+	return position;
+}
+
+constexpr size_t keyword_hash(const string_view text) noexcept
+{
+	return (static_cast<unsigned char>(text[0]) ^ text.size()) & 15;
+}
+
+// perfect hash table of the keywords, an identifier is compared with at most one keyword
+constexpr auto keyword_table = []
+{
+	array<keyword_kind, 16> result{};
+	for (size_t i = 0; i < size(keywords); i++)
+	{
+		if (result[keyword_hash(keywords[i])] != not_keyword)
+			throw "keyword hash collision";
+		result[keyword_hash(keywords[i])] = static_cast<keyword_kind>(i + 1);
+	}
+	return result;
+}();
+
+inline keyword_kind resolve_keyword(const string_view text) noexcept
+{
+	const auto kind = keyword_table[keyword_hash(text)];
+	return kind != not_keyword && keywords[kind - 1] == text ? kind : not_keyword;
+}
+
+inline bool contains(const string_view range, const char* position) noexcept
+{
+	constexpr less<const char*> is_before{};
+	return !is_before(position, range.data()) && is_before(position, range.data() + range.size());
+}
+
+bool xcl::parser::lex_token(const std::string_view input, size_t& position, const bool is_final, token& result)
+{
+	const auto start = position = scan_run(input, position, whitespace_char);
+	if (start == input.size())
+		return false;
+
+	auto end = start + 1;
+	token_type type;
+	auto kind = not_keyword;
+
+	switch (char_class_of(input[start]))
+	{
+	case new_line_char:
+		type = new_line;
+		break;
+	case string_char:
+	{
+		type = string_literal;
+		const auto closing = input.find('"', end);
+		if (closing == string_view::npos && !is_final)
+			return false;
+		end = closing == string_view::npos ? input.size() : closing + 1;
+		break;
+	}
+	case digit_char:
+		type = number_literal;
+		end = scan_run(input, end, digit_char);
+		break;
+	case letter_char:
+		end = scan_run(input, end, letter_char | digit_char);
+		kind = resolve_keyword(input.substr(start, end - start));
+		type = kind != not_keyword ? keyword : identifier;
+		break;
+	case punctuation_char:
+		// every punctuation character is a token of its own, so `},` is two tokens
+		type = punctuation_type(input[start]);
+		break;
+	default:
+		throw xcl::errors::invalid_character_error(input[start]);
+	}
+
+	// a run that reaches the end of the buffer may continue in the rest of the input
+	if (!is_final && end == input.size() && (type == number_literal || type == identifier || type == keyword))
+		return false;
+
+	const auto text = input.substr(start, end - start);
+	// identifiers are interned only once they are complete
+	result = type == identifier ? token(text, xcl::symbol_table::get_instance().intern(text)) : token(type, text, kind);
+	position = end;
+	return true;
+}
+
+std::optional<text_location> tokens_vector::locate(const char* position) const
+{
+	if (!contains(source_, position))
+		return nullopt;
+	if (!lines_)
+	{
+		lines_.emplace();
+		lines_->add_text(source_);
+	}
+	return lines_->locate(position - source_.data());
+}
+
+void token_stream::advance()
+{
+	if (!read_token(current_))
+	{
+		at_end_ = true;
+	}
+}
+
+vector_token_stream::vector_token_stream(const tokens_vector& tokens) : tokens_(tokens), iter_(tokens.begin())
+{
+	advance();
+}
+
+std::optional<text_location> vector_token_stream::locate(const char* position) const
+{
+	return tokens_.locate(position);
+}
+
+bool vector_token_stream::read_token(token& result)
+{
+	if (iter_ == tokens_.end())
+		return false;
+	result = *iter_++;
+	return true;
+}
+
+source_token_stream::source_token_stream(const std::string_view source) : source_(source)
+{
+	advance();
+}
+
+source_token_stream::source_token_stream(const std::string_view source, const size_t begin) : source_(source), position_(begin)
+{
+	advance();
+}
+
+std::optional<text_location> source_token_stream::locate(const char* position) const
+{
+	if (!contains(source_, position))
+		return nullopt;
+	if (!lines_)
+	{
+		lines_.emplace();
+		lines_->add_text(source_);
+	}
+	return lines_->locate(position - source_.data());
+}
+
+bool source_token_stream::read_token(token& result)
+{
+	return lex_token(source_, position_, true, result);
+}
+
+chunked_token_stream::chunked_token_stream(std::istream& input, const size_t chunk_size) : input_(input), chunk_size_(chunk_size)
+{
+	advance();
+}
+
+std::optional<text_location> chunked_token_stream::locate(const char* position) const
+{
+	if (!contains(buffer_, position))
+		return nullopt;
+	return lines_.locate(buffer_offset_ + (position - buffer_.data()));
+}
+
+bool chunked_token_stream::read_token(token& result)
+{
+	while (!lex_token(buffer_, position_, is_final_, result))
+	{
+		if (is_final_)
+			return false;
+		read_chunk(result);
+	}
+
+	current_start_ = result.get_text().data() - buffer_.data();
+	return true;
+}
+
+pipelined_token_stream::pipelined_token_stream(std::istream& input, const size_t chunk_size) : input_(input), chunk_size_(chunk_size)
+{
+	reader_ = thread(&pipelined_token_stream::read_input, this);
+	lexer_ = thread(&pipelined_token_stream::lex_input, this);
+	try
+	{
+		advance();
+	}
+	catch (...)
+	{
+		stop();
+		throw;
+	}
+}
+
+pipelined_token_stream::~pipelined_token_stream()
+{
+	stop();
+}
+
+void pipelined_token_stream::stop()
+{
+	// the parser may stop early, closing the rings releases the stages blocked on them
+	batches_.close();
+	chunks_.close();
+	lexer_.join();
+	reader_.join();
+}
+
+std::optional<text_location> pipelined_token_stream::locate(const char* position) const
+{
+	const string_view text(batch_.text.data(), batch_.text.size());
+	if (!contains(text, position))
+		return nullopt;
+	const auto before = text.substr(0, position - text.data());
+	const auto line_start = before.rfind('\n');
+	if (line_start == string_view::npos)
+		return text_location{ batch_.start.line, batch_.start.column + static_cast<int>(before.size()) };
+	return text_location{ batch_.start.line + static_cast<int>(ranges::count(before, '\n')), static_cast<int>(before.size() - line_start) };
+}
+
+bool pipelined_token_stream::read_token(token& result)
+{
+	// the previous batch stays alive until the next one arrives, so the current token is valid at the end
+	while (next_token_ == batch_.tokens.size())
+	{
+		auto batch = batches_.pop();
+		if (!batch)
+			return false;
+		if (batch->error)
+			rethrow_exception(batch->error);
+		batch_ = std::move(*batch);
+		next_token_ = 0;
+	}
+
+	result = batch_.tokens[next_token_++];
+	return true;
+}
+
+void pipelined_token_stream::read_input()
+{
+	try
+	{
+		while (input_)
+		{
+			string chunk(chunk_size_, '\0');
+			input_.read(chunk.data(), static_cast<streamsize>(chunk_size_));
+			chunk.resize(static_cast<size_t>(input_.gcount()));
+			if (chunk.empty() || !chunks_.push(std::move(chunk)))
+				break;
+		}
+	}
+	catch (...)
+	{
+		input_error_ = current_exception();
+	}
+	chunks_.close();
+}
+
+void pipelined_token_stream::lex_input()
+{
+	string buffer;
+	size_t position = 0;
+	token_batch batch;
+
+	// hands the complete tokens of the buffer to the parser, only an incomplete token at the end is kept
+	const auto flush = [&]
+	{
+		if (batch.tokens.empty())
+			return true;
+		vector<size_t> offsets;
+		offsets.reserve(batch.tokens.size());
+		for (const auto& lexed : batch.tokens)
+			offsets.push_back(lexed.get_text().data() - buffer.data());
+
+		const auto start = batch.start;
+		batch.text.assign(buffer.begin(), buffer.begin() + static_cast<ptrdiff_t>(position));
+		buffer.erase(0, position);
+		position = 0;
+		const string_view text(batch.text.data(), batch.text.size());
+		for (size_t index = 0; index < offsets.size(); ++index)
+			batch.tokens[index] = batch.tokens[index].with_text(text.substr(offsets[index], batch.tokens[index].get_text().size()));
+
+		auto next = start;
+		if (const auto line_start = text.rfind('\n'); line_start == string_view::npos)
+		{
+			next.column += static_cast<int>(text.size());
+		}
+		else
+		{
+			next.line += static_cast<int>(ranges::count(text, '\n'));
+			next.column = static_cast<int>(text.size() - line_start);
+		}
+		if (!batches_.push(std::move(batch)))
+			return false;
+		batch = {};
+		batch.start = next;
+		return true;
+	};
+
+	try
+	{
+		for (auto is_final = false; ;)
+		{
+			token result{new_line, {}};
+			while (lex_token(buffer, position, is_final, result))
+				batch.tokens.push_back(result);
+			if (!flush() || is_final)
+				break;
+
+			if (auto chunk = chunks_.pop())
+			{
+				buffer += *chunk;
+			}
+			else
+			{
+				is_final = true;
+				if (input_error_)
+					rethrow_exception(input_error_);
+			}
+		}
+	}
+	catch (...)
+	{
+		token_batch error;
+		error.error = current_exception();
+		if (flush())
+			batches_.push(std::move(error));
+	}
+	batches_.close();
+}
+
+void chunked_token_stream::read_chunk(token& current)
+{
+	// drop the consumed input, except the current token which the parser may still refer to
+	const auto consumed = current_start_ == string::npos ? position_ : current_start_;
+	buffer_.erase(0, consumed);
+	buffer_offset_ += consumed;
+	position_ -= consumed;
+
+	const auto size = buffer_.size();
+	buffer_.resize(size + chunk_size_);
+	input_.read(buffer_.data() + size, static_cast<streamsize>(chunk_size_));
+	buffer_.resize(size + static_cast<size_t>(input_.gcount()));
+	is_final_ = !input_;
+	lines_.add_text(string_view(buffer_).substr(size));
+
+	if (current_start_ != string::npos)
+	{
+		current_start_ = 0;
+		current = current.with_text(string_view(buffer_).substr(0, current.get_text().size()));
+	}
+}
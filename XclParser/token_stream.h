@@ -0,0 +1,186 @@
+﻿#pragma once
+
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "spsc_ring.h"
+#include "token.h"
+
+namespace xcl::parser
+{
+	// tokens are views into the source, when the source was read by the tokenizer the vector keeps it alive
+	class tokens_vector
+	{
+	public:
+		tokens_vector() = default;
+		explicit tokens_vector(const std::string_view source) : source_(source) {}
+
+		typedef std::vector<token>::const_iterator const_iterator;
+
+		[[nodiscard]] const_iterator begin() const noexcept { return tokens_.begin(); }
+		[[nodiscard]] const_iterator end() const noexcept { return tokens_.end(); }
+		[[nodiscard]] size_t size() const noexcept { return tokens_.size(); }
+		[[nodiscard]] bool empty() const noexcept { return tokens_.empty(); }
+		[[nodiscard]] const token& operator[](const size_t index) const noexcept { return tokens_[index]; }
+
+		void add_token(const token& token) { tokens_.push_back(token); }
+
+		void hold_source(std::shared_ptr<const std::string> source) noexcept { owner_ = std::move(source); }
+
+		[[nodiscard]] std::optional<text_location> locate(const char* position) const;
+
+	private:
+		std::shared_ptr<const std::string> owner_;
+		std::string_view source_;
+		std::vector<token> tokens_;
+		mutable std::optional<line_index> lines_;
+	};
+
+	typedef tokens_vector::const_iterator tokens_iter;
+
+	// pull based source of tokens, tokens are produced one at a time while the parser consumes them
+	class token_stream
+	{
+	public:
+		token_stream(const token_stream&) = delete;
+		token_stream(token_stream&&) = delete;
+		virtual ~token_stream() = default;
+
+		// the current token is valid until the stream is advanced, after the end it stays on the last token
+		[[nodiscard]] const token& current() const noexcept { return current_; }
+		[[nodiscard]] bool at_end() const noexcept { return at_end_; }
+
+		void advance();
+
+		// resolves a position inside a token read from this stream to its line and column
+		[[nodiscard]] virtual std::optional<text_location> locate(const char* position) const = 0;
+
+		token_stream& operator=(const token_stream&) = delete;
+		token_stream& operator=(token_stream&&) = delete;
+
+	protected:
+		token_stream() = default;
+
+		// reads the next token into result, returns false at the end of the input
+		virtual bool read_token(token& result) = 0;
+
+	private:
+		token current_{new_line, {}};
+		bool at_end_{false};
+	};
+
+	class vector_token_stream final : public token_stream
+	{
+	public:
+		explicit vector_token_stream(const tokens_vector& tokens);
+
+		[[nodiscard]] std::optional<text_location> locate(const char* position) const override;
+
+	protected:
+		bool read_token(token& result) override;
+
+	private:
+		const tokens_vector& tokens_;
+		tokens_iter iter_;
+	};
+
+	// lexes a contiguous source on demand, tokens are views into the source
+	class source_token_stream final : public token_stream
+	{
+	public:
+		explicit source_token_stream(std::string_view source);
+
+		// lexes from an offset, tokens are still located relative to the start of the source
+		source_token_stream(std::string_view source, size_t begin);
+
+		[[nodiscard]] std::optional<text_location> locate(const char* position) const override;
+
+	protected:
+		bool read_token(token& result) override;
+
+	private:
+		std::string_view source_;
+		size_t position_{0};
+		mutable std::optional<line_index> lines_;
+	};
+
+	// reads the input in fixed-size chunks, only the unconsumed part of the current chunk is kept in memory
+	class chunked_token_stream final : public token_stream
+	{
+	public:
+		static constexpr size_t default_chunk_size = 64 * 1024;
+
+		explicit chunked_token_stream(std::istream& input, size_t chunk_size = default_chunk_size);
+
+		[[nodiscard]] std::optional<text_location> locate(const char* position) const override;
+
+	protected:
+		bool read_token(token& result) override;
+
+	private:
+		void read_chunk(token& current);
+
+		std::istream& input_;
+		size_t chunk_size_;
+		std::string buffer_;
+		// offset of the start of the buffer in the whole input
+		size_t buffer_offset_{0};
+		size_t position_{0};
+		size_t current_start_{std::string::npos};
+		bool is_final_{false};
+		line_index lines_;
+	};
+
+	// reads the input on one thread and lexes it on another, the parser consumes the token batches while the next ones are produced
+	// the stages are connected by bounded rings, so a slow stage holds back the ones before it
+	class pipelined_token_stream final : public token_stream
+	{
+	public:
+		static constexpr size_t ring_capacity = 4;
+
+		explicit pipelined_token_stream(std::istream& input, size_t chunk_size = chunked_token_stream::default_chunk_size);
+		~pipelined_token_stream() override;
+
+		[[nodiscard]] std::optional<text_location> locate(const char* position) const override;
+
+	protected:
+		bool read_token(token& result) override;
+
+	private:
+		// the tokens lexed from one chunk, they are views into the text of the batch
+		struct token_batch
+		{
+			// unlike a short string, a vector keeps its storage in place when the batch is moved
+			std::vector<char> text;
+			std::vector<token> tokens;
+			// location of the start of the text in the whole input
+			text_location start{1, 1};
+			// a lexer or input error is delivered after the tokens before it
+			std::exception_ptr error;
+		};
+
+		void read_input();
+		void lex_input();
+		void stop();
+
+		std::istream& input_;
+		size_t chunk_size_;
+		std::exception_ptr input_error_;
+		spsc_ring<std::string> chunks_{ring_capacity};
+		spsc_ring<token_batch> batches_{ring_capacity};
+		token_batch batch_;
+		size_t next_token_{0};
+		std::thread reader_;
+		std::thread lexer_;
+	};
+
+	// skips whitespace, lexes the next token into result and moves position after it
+	// returns false when the input holds no complete token, for a non-final input that means more input is needed
+	bool lex_token(std::string_view input, size_t& position, bool is_final, token& result);
+}
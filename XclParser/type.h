@@ -1,8 +1,11 @@
 ﻿#pragma once
 
 #include <memory>
+#include <memory_resource>
 #include <string>
 
+#include "value.h"
+
 namespace xcl::parser
 {
 	class token;
@@ -23,7 +26,8 @@ namespace xcl::types
 		virtual ~type() = default;
 
 		[[nodiscard]] const std::string& get_name() const { return name_; }
-		[[nodiscard]] virtual std::unique_ptr<xcl::objects::object> activate(const xcl::parser::token&) const = 0;
+		[[nodiscard]] size_t get_name_hash() const noexcept { return name_hash_; }
+		[[nodiscard]] virtual xcl::value activate(const xcl::parser::token&, std::pmr::memory_resource& arena) const = 0;
 
 		[[nodiscard]] virtual bool is_custom_type() { return true; }
 
@@ -31,9 +35,10 @@ namespace xcl::types
 		type& operator=(const type& other) noexcept = delete;
 
 	protected:
-		explicit type(std::string name) : name_(std::move(name)) {}
+		explicit type(std::string name) : name_(std::move(name)), name_hash_(std::hash<std::string>{}(name_)) {}
 
 	private:
 		std::string name_;
+		size_t name_hash_;
 	};
 }
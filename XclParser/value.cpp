@@ -0,0 +1,151 @@
+﻿#include "pch.h"
+#include "value.h"
+
+#include <cstring>
+
+#include "boolean.h"
+#include "enumeration.h"
+#include "exception.h"
+#include "list.h"
+#include "number.h"
+#include "section.h"
+#include "xcl_string.h"
+
+xcl::value::value(const xcl::types::number& type, const long integer) noexcept : type_(&type), integer_(integer), kind_(integer_value)
+{
+}
+
+xcl::value::value(const xcl::types::boolean& type, const bool boolean) noexcept : type_(&type), boolean_(boolean), kind_(boolean_value)
+{
+}
+
+xcl::value::value(const xcl::types::enumeration& type, const int index) noexcept : type_(&type), index_(index), kind_(enumeration_value)
+{
+}
+
+xcl::value::value(const xcl::types::string& type, const std::string_view text) noexcept :
+	type_(&type), text_(text.data()), length_(static_cast<uint32_t>(text.size())), kind_(string_value)
+{
+}
+
+xcl::value::value(const xcl::objects::section& section) noexcept : type_(&section.get_type()), container_(&section), kind_(section_value)
+{
+}
+
+xcl::value::value(const xcl::objects::list& list) noexcept : type_(&list.get_type()), container_(&list), kind_(list_value)
+{
+}
+
+const std::string& xcl::value::as_enumeration_name() const
+{
+	expect_kind(enumeration_value);
+	return static_cast<const xcl::types::enumeration*>(type_)->get_values()[index_];
+}
+
+const xcl::objects::section& xcl::value::as_section() const
+{
+	expect_kind(section_value);
+	return *static_cast<const xcl::objects::section*>(container_);
+}
+
+const xcl::objects::list& xcl::value::as_list() const
+{
+	expect_kind(list_value);
+	return *static_cast<const xcl::objects::list*>(container_);
+}
+
+std::string xcl::value::to_string() const
+{
+	switch (kind_)
+	{
+	case integer_value:
+		return std::to_string(integer_);
+	case boolean_value:
+		return boolean_ ? "True" : "False";
+	case enumeration_value:
+		return as_enumeration_name();
+	case string_value:
+		return std::string(text_, length_);
+	case section_value:
+	case list_value:
+		return container_->to_string();
+	case empty_value:
+		break;
+	}
+	return {};
+}
+
+size_t xcl::value::get_hash() const noexcept
+{
+	if (kind_ == empty_value)
+		return 0;
+
+	const auto seed = hash_combine(kind_, type_->get_name_hash());
+	switch (kind_)
+	{
+	case integer_value:
+		return hash_combine(seed, std::hash<long>{}(integer_));
+	case boolean_value:
+		return hash_combine(seed, std::hash<bool>{}(boolean_));
+	case enumeration_value:
+		// by name, so that renaming an enumerator changes the value and reordering them does not
+		return hash_combine(seed, std::hash<std::string_view>{}(static_cast<const xcl::types::enumeration*>(type_)->get_values()[index_]));
+	case string_value:
+		return hash_combine(seed, std::hash<std::string_view>{}({ text_, length_ }));
+	case section_value:
+	case list_value:
+		return hash_combine(seed, container_->get_hash());
+	case empty_value:
+		break;
+	}
+	return seed;
+}
+
+std::shared_ptr<const xcl::objects::object> xcl::value::to_object() const
+{
+	switch (kind_)
+	{
+	case integer_value:
+		return std::make_shared<xcl::objects::number>(*static_cast<const xcl::types::number*>(type_), integer_);
+	case boolean_value:
+		return std::make_shared<xcl::objects::boolean>(*static_cast<const xcl::types::boolean*>(type_), boolean_);
+	case enumeration_value:
+		return std::make_shared<xcl::objects::enumeration>(*static_cast<const xcl::types::enumeration*>(type_), index_);
+	case string_value:
+		return std::make_shared<xcl::objects::string>(*static_cast<const xcl::types::string*>(type_), std::pmr::string(text_, length_));
+	case section_value:
+	case list_value:
+		// not owned, the container lives in the arena of its document
+		return { std::shared_ptr<const xcl::objects::object>(), container_ };
+	case empty_value:
+		break;
+	}
+	return nullptr;
+}
+
+xcl::value xcl::value::clone(std::pmr::memory_resource& arena) const
+{
+	switch (kind_)
+	{
+	case string_value:
+	{
+		const auto text = static_cast<char*>(arena.allocate(length_, alignof(char)));
+		std::memcpy(text, text_, length_);
+		return { *static_cast<const xcl::types::string*>(type_), std::string_view(text, length_) };
+	}
+	case section_value:
+		return value(*static_cast<const xcl::objects::section*>(container_->clone(arena)));
+	case list_value:
+		return value(*static_cast<const xcl::objects::list*>(container_->clone(arena)));
+	default:
+		return *this;
+	}
+}
+
+void xcl::value::expect_kind(const value_kind kind) const
+{
+	if (kind_ != kind)
+	{
+		throw errors::xcl_runtime_error(std::format("A value of type `{}` can not be read as another kind of value.", type_ != nullptr ? type_->get_name() : ""));
+	}
+}
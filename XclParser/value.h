@@ -0,0 +1,96 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+
+namespace xcl::types
+{
+	class type;
+	class number;
+	class boolean;
+	class enumeration;
+	class string;
+}
+
+namespace xcl::objects
+{
+	class object;
+	class section;
+	class list;
+}
+
+namespace xcl
+{
+	enum value_kind : unsigned char
+	{
+		empty_value,
+		integer_value,
+		boolean_value,
+		enumeration_value,
+		string_value,
+		section_value,
+		list_value,
+	};
+
+	// values are stored inline in documents, sections and lists, scalars are read without any indirection
+	class value
+	{
+	public:
+		value() = default;
+		value(const xcl::types::number& type, long integer) noexcept;
+		value(const xcl::types::boolean& type, bool boolean) noexcept;
+		value(const xcl::types::enumeration& type, int index) noexcept;
+		// the text is not copied, it must live as long as the value, usually in the arena of the document
+		value(const xcl::types::string& type, std::string_view text) noexcept;
+		explicit value(const xcl::objects::section& section) noexcept;
+		explicit value(const xcl::objects::list& list) noexcept;
+
+		[[nodiscard]] value_kind get_kind() const noexcept { return kind_; }
+		[[nodiscard]] bool is_empty() const noexcept { return kind_ == empty_value; }
+
+		[[nodiscard]] const xcl::types::type& get_type() const noexcept { return *type_; }
+
+		[[nodiscard]] long as_integer() const { expect_kind(integer_value); return integer_; }
+		[[nodiscard]] bool as_boolean() const { expect_kind(boolean_value); return boolean_; }
+		[[nodiscard]] int as_enumeration_index() const { expect_kind(enumeration_value); return index_; }
+		[[nodiscard]] const std::string& as_enumeration_name() const;
+		[[nodiscard]] std::string_view as_string() const { expect_kind(string_value); return { text_, length_ }; }
+		[[nodiscard]] const xcl::objects::section& as_section() const;
+		[[nodiscard]] const xcl::objects::list& as_list() const;
+
+		[[nodiscard]] std::string to_string() const;
+
+		// structural hash of the type name and the content, equal values of any two documents have equal hashes
+		[[nodiscard]] size_t get_hash() const noexcept;
+
+		// polymorphic view of the value, scalars are materialized while sections and lists are returned as they are
+		[[nodiscard]] std::shared_ptr<const xcl::objects::object> to_object() const;
+
+		[[nodiscard]] value clone(std::pmr::memory_resource& arena) const;
+
+	private:
+		void expect_kind(value_kind kind) const;
+
+		const xcl::types::type* type_ = nullptr;
+		union
+		{
+			long integer_;
+			bool boolean_;
+			int index_;
+			const char* text_;
+			const xcl::objects::object* container_ = nullptr;
+		};
+		uint32_t length_ = 0;
+		value_kind kind_ = empty_value;
+	};
+
+	static_assert(sizeof(value) <= 24);
+
+	[[nodiscard]] constexpr size_t hash_combine(const size_t seed, const size_t hash) noexcept
+	{
+		return seed ^ (hash + 0x9e3779b97f4a7c15 + (seed << 6) + (seed >> 2));
+	}
+}
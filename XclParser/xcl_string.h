@@ -17,8 +17,8 @@ namespace xcl::types
 	public:
 		string() : type("string") {}
 
-		[[nodiscard]] std::unique_ptr<xcl::objects::string> activate(const std::string& value) const noexcept;
-		[[nodiscard]] std::unique_ptr<xcl::objects::object> activate(const xcl::parser::token&) const override;
+		[[nodiscard]] xcl::value activate(std::string_view value, std::pmr::memory_resource& arena) const;
+		[[nodiscard]] xcl::value activate(const xcl::parser::token&, std::pmr::memory_resource& arena) const override;
 
 		bool is_custom_type() override { return false; }
 
@@ -34,13 +34,17 @@ namespace xcl::objects
 	class string final : public object
 	{
 	public:
-		string(const xcl::types::string& type, std::string value) : object(type), value_(std::move(value)) {}
+		string(const xcl::types::string& type, std::pmr::string value) : object(type), value_(std::move(value)) {}
+		string(const string& other, std::pmr::memory_resource& arena) : object(other), value_(other.value_, &arena) {}
 
-		[[nodiscard]] const std::string& get_value() const { return value_; }
-		[[nodiscard]] std::unique_ptr<xcl::objects::object> clone() const override;
+		[[nodiscard]] std::string_view get_value() const { return value_; }
+		[[nodiscard]] xcl::objects::object* clone(std::pmr::memory_resource& arena) const override;
 		[[nodiscard]] std::string to_string() const override;
 
+	protected:
+		[[nodiscard]] size_t compute_hash() const noexcept override { return xcl::value(static_cast<const xcl::types::string&>(get_type()), std::string_view(value_)).get_hash(); }
+
 	private:
-		std::string value_;
+		std::pmr::string value_;
 	};
 }
@@ -16,9 +16,6 @@ inline std::ostream& operator<<(std::ostream& os, const xcl::parser::token_type&
 {
 	switch (type)
 	{
-	case xcl::parser::whitespace:
-		os << "whitespace";
-		break;
 	case xcl::parser::new_line:
 		os << "new_line";
 		break;
@@ -34,8 +31,17 @@ inline std::ostream& operator<<(std::ostream& os, const xcl::parser::token_type&
 	case xcl::parser::identifier:
 		os << "identifier";
 		break;
-	case xcl::parser::operator_symbol:
-		os << "operator_symbol";
+	case xcl::parser::left_brace:
+		os << "left_brace";
+		break;
+	case xcl::parser::right_brace:
+		os << "right_brace";
+		break;
+	case xcl::parser::equals:
+		os << "equals";
+		break;
+	case xcl::parser::comma:
+		os << "comma";
 		break;
 	}
 	return os;
@@ -68,13 +74,12 @@ int main()
 	istringstream test2_xcl_stream(test2_xcl_ptr);
 
 	xcl::parser::tokenizer tokenizer{};
-	tokenizer.initialize();
 	xcl::parser::document_parser parser{};
 	parser.initialize([&tokenizer, &parser, &test_xcl_stream](const std::string& name)
 		{
 			if (name != "Test.xcl") throw exception("file not found");
 			const auto tokens = tokenizer.tokenize(test_xcl_stream);
-			return parser.parse(tokens, true);
+			return make_shared<const xcl::document>(parser.parse(tokens, true));
 		});
 
 	try {
@@ -84,8 +89,8 @@ int main()
 		for (const auto& [name, value] : document.get_data())
 		{
 			cout << "Key: " << name << endl;
-			cout << "Value Type: " << value->get_type().get_name() << endl;
-			cout << "Value: " << value->to_string() << endl << endl;
+			cout << "Value Type: " << value.get_type().get_name() << endl;
+			cout << "Value: " << value.to_string() << endl << endl;
 		}
 	} catch (const xcl::errors::xcl_exception& exception)
 	{